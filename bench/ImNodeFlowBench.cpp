@@ -0,0 +1,257 @@
+/**
+ * Headless benchmarks of the ImNodeFlow hot paths.
+ *
+ * Usage: ImNodeFlowBench [--sizes 100,1000,10000,100000] [--shape wide_dag] [--fan-in 2] [--fan-out 1] [--frames 60] [--warmup 5] [--seed 1] [--out file.json]
+ *
+ * For each graph size: frame time (whole ImGui frame and ImNodeFlow::update() alone), evaluation time of the whole graph,
+ * heap allocations and vertices per frame. Then micro-benchmarks of smart_bezier_collider, OutPin::val() and AppendDrawData.
+ * Results are written as JSON (stdout by default), progress goes to stderr.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <ImNodeFlow.h>
+#include "alloc_counter.h"
+#include "headless_imgui.h"
+#include "graph_generator.h"
+
+using namespace ImFlowBench;
+using Clock = std::chrono::steady_clock;
+
+static double ms_since(Clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+}
+
+struct Options
+{
+    std::vector<std::size_t> sizes = {100, 1000, 10000, 100000};
+    GraphShape               shape = GraphShape_WideDag;
+    int                      fanIn = 2;
+    int                      fanOut = 1;
+    int                      frames = 60;
+    int                      warmup = 5;
+    uint32_t                 seed = 1;
+    std::string              out;
+};
+
+struct Timings
+{
+    double mean = 0, p50 = 0, p95 = 0, max = 0;
+
+    static Timings of(std::vector<double> v)
+    {
+        Timings t;
+        if (v.empty())
+            return t;
+        std::sort(v.begin(), v.end());
+        for (double x: v) { t.mean += x; }
+        t.mean /= static_cast<double>(v.size());
+        t.p50 = v[v.size() / 2];
+        t.p95 = v[std::min(v.size() - 1, v.size() * 95 / 100)];
+        t.max = v.back();
+        return t;
+    }
+
+    void write(std::ostream& os) const
+    { os << "{\"mean\":" << mean << ",\"p50\":" << p50 << ",\"p95\":" << p95 << ",\"max\":" << max << "}"; }
+};
+
+static void bench_graph(std::ostream& os, HeadlessImGui& gui, const Options& opt, std::size_t size)
+{
+    std::cerr << "graph of " << size << " nodes\n";
+    ImFlow::ImNodeFlow inf("bench");
+
+    auto t = Clock::now();
+    GeneratedGraph g = generate(inf, {size, opt.fanIn, opt.fanOut, 64, opt.seed, opt.shape});
+    double build = ms_since(t);
+
+    for (int i = 0; i < opt.warmup; i++)
+    {
+        gui.beginFrame();
+        inf.update();
+        gui.endFrame();
+    }
+
+    std::vector<double> frames, updates;
+    frames.reserve(opt.frames);
+    updates.reserve(opt.frames);
+    uint64_t vertices = 0, indices = 0, commands = 0, libraryAllocs = 0;
+    AllocCount allocStart = alloc_count();
+    uint64_t callsStart = behaviour_calls();
+    for (int i = 0; i < opt.frames; i++)
+    {
+        auto f = Clock::now();
+        gui.beginFrame();
+        auto u = Clock::now();
+        inf.update();
+        updates.push_back(ms_since(u));
+        ImDrawData* data = gui.endFrame();
+        frames.push_back(ms_since(f));
+        libraryAllocs += inf.getFrameAllocations().totalCount();
+        vertices += data->TotalVtxCount;
+        indices += data->TotalIdxCount;
+        for (int l = 0; l < data->CmdListsCount; l++)
+            commands += data->CmdLists[l]->CmdBuffer.Size;
+    }
+    AllocCount allocs = alloc_count() - allocStart;
+    uint64_t calls = behaviour_calls() - callsStart;
+
+    // Evaluation of every node, without drawing
+    for (auto &n: g.nodes) { n->setSink(true); }
+    inf.sinkDriven(true);
+    std::vector<double> evals;
+    for (int i = 0; i < opt.frames; i++)
+    {
+        auto e = Clock::now();
+        inf.evaluate();
+        inf.finishEvaluation();
+        evals.push_back(ms_since(e));
+    }
+    inf.sinkDriven(false);
+
+    auto n = static_cast<double>(std::max(opt.frames, 1));
+    os << "{\"nodes\":" << size << ",\"links\":" << g.links << ",\"build_ms\":" << build
+       << ",\"frame_ms\":"; Timings::of(frames).write(os);
+    os << ",\"update_ms\":"; Timings::of(updates).write(os);
+    os << ",\"eval_ms\":"; Timings::of(evals).write(os);
+    os << ",\"allocs_per_frame\":" << static_cast<double>(allocs.count) / n
+       << ",\"alloc_bytes_per_frame\":" << static_cast<double>(allocs.bytes) / n
+       << ",\"library_allocs_per_frame\":" << static_cast<double>(libraryAllocs) / n
+       << ",\"vertices_per_frame\":" << static_cast<double>(vertices) / n
+       << ",\"indices_per_frame\":" << static_cast<double>(indices) / n
+       << ",\"draw_cmds_per_frame\":" << static_cast<double>(commands) / n
+       << ",\"behaviour_calls_per_frame\":" << static_cast<double>(calls) / n << "}";
+}
+
+static double bench_bezier_collider(uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> d(0.f, 1000.f);
+    constexpr int calls = 200000;
+    std::vector<ImVec2> pts(3 * 1024);
+    for (auto &p: pts) { p = ImVec2(d(rng), d(rng)); }
+
+    int hits = 0;
+    auto t = Clock::now();
+    for (int i = 0; i < calls; i++)
+    {
+        std::size_t k = (i % 1024) * 3;
+        hits += ImFlow::smart_bezier_collider(pts[k], pts[k + 1], pts[k + 2], 2.5f);
+    }
+    double ns = ms_since(t) * 1e6 / calls;
+    std::cerr << "bezier collider: " << hits << " hits\n";
+    return ns;
+}
+
+static double bench_outpin_val(HeadlessImGui& gui, uint32_t seed)
+{
+    ImFlow::ImNodeFlow inf("val");
+    GeneratedGraph g = generate(inf, {256, 2, 1, 16, seed});
+    gui.beginFrame();
+    inf.update();
+    gui.endFrame();
+
+    constexpr int calls = 1000000;
+    float sum = 0.f;
+    auto t = Clock::now();
+    for (int i = 0; i < calls; i++)
+        sum += g.nodes[i % g.nodes.size()]->outs().front()->val();
+    double ns = ms_since(t) * 1e6 / calls;
+    std::cerr << "val: " << sum << "\n";
+    return ns;
+}
+
+static double bench_append_draw_data(HeadlessImGui& gui, int frames)
+{
+    gui.beginFrame();
+    ImDrawList src(ImGui::GetDrawListSharedData());
+    src._ResetForNewFrame();
+    src.PushClipRectFullScreen();
+    for (int i = 0; i < 10000; i++)
+        src.AddRectFilled(ImVec2(float(i % 100) * 10.f, float(i / 100) * 10.f), ImVec2(float(i % 100) * 10.f + 8.f, float(i / 100) * 10.f + 8.f), IM_COL32_WHITE);
+    gui.endFrame();
+
+    double ms = 0.;
+    for (int f = 0; f < frames; f++)
+    {
+        gui.beginFrame();
+        auto t = Clock::now();
+        AppendDrawData(&src, ImVec2(10.f, 10.f), 0.5f);
+        ms += ms_since(t);
+        gui.endFrame();
+    }
+    return ms * 1e6 / (static_cast<double>(std::max(frames, 1)) * src.VtxBuffer.Size);
+}
+
+static bool parse(int argc, char** argv, Options& opt)
+{
+    constexpr GraphShape shapes[] = {GraphShape_WideDag, GraphShape_Chain, GraphShape_Tree, GraphShape_FanOut, GraphShape_DynamicPins};
+    for (int i = 1; i < argc; i++)
+    {
+        std::string a = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        std::string v = argv[++i];
+        if (a == "--sizes")
+        {
+            opt.sizes.clear();
+            std::stringstream ss(v);
+            for (std::string s; std::getline(ss, s, ',');)
+                opt.sizes.push_back(std::stoul(s));
+        }
+        else if (a == "--shape")
+        {
+            auto s = std::find_if(std::begin(shapes), std::end(shapes), [&](GraphShape s) { return v == shape_name(s); });
+            if (s == std::end(shapes))
+                return false;
+            opt.shape = *s;
+        }
+        else if (a == "--fan-in") opt.fanIn = std::stoi(v);
+        else if (a == "--fan-out") opt.fanOut = std::stoi(v);
+        else if (a == "--frames") opt.frames = std::stoi(v);
+        else if (a == "--warmup") opt.warmup = std::stoi(v);
+        else if (a == "--seed") opt.seed = static_cast<uint32_t>(std::stoul(v));
+        else if (a == "--out") opt.out = v;
+        else
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!parse(argc, argv, opt))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--sizes 100,1000,...] [--shape wide_dag|chain|tree|fan_out|dynamic_pins] [--fan-in N] [--fan-out N] [--frames N] [--warmup N] [--seed N] [--out file.json]\n";
+        return 1;
+    }
+
+    HeadlessImGui gui;
+    std::ostringstream os;
+    os << "{\"imgui\":\"" << IMGUI_VERSION << "\",\"shape\":\"" << shape_name(opt.shape) << "\",\"fan_in\":" << opt.fanIn << ",\"fan_out\":" << opt.fanOut
+       << ",\"frames\":" << opt.frames << ",\"seed\":" << opt.seed << ",\"graphs\":[";
+    for (std::size_t i = 0; i < opt.sizes.size(); i++)
+    {
+        os << (i ? "," : "");
+        bench_graph(os, gui, opt, opt.sizes[i]);
+    }
+    os << "],\"micro\":{\"bezier_collider_ns\":" << bench_bezier_collider(opt.seed)
+       << ",\"outpin_val_ns\":" << bench_outpin_val(gui, opt.seed)
+       << ",\"append_draw_data_ns_per_vertex\":" << bench_append_draw_data(gui, opt.frames) << "}}\n";
+
+    if (opt.out.empty())
+        std::cout << os.str();
+    else
+        std::ofstream(opt.out) << os.str();
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "alloc_counter.h"
+
+#include <new>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+static std::atomic<uint64_t> s_count = 0;
+static std::atomic<uint64_t> s_bytes = 0;
+
+static void* counted_alloc(std::size_t size, std::size_t align)
+{
+    s_count.fetch_add(1, std::memory_order_relaxed);
+    s_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0)
+        size = 1;
+    if (align == 0)
+        return std::malloc(size);
+    // The MSVC CRT has no std::aligned_alloc, and its aligned blocks must go back through _aligned_free
+#ifdef _WIN32
+    return _aligned_malloc(size, align);
+#else
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+}
+
+static void counted_free(void* p, bool aligned) noexcept
+{
+#ifdef _WIN32
+    if (aligned) {
+        _aligned_free(p);
+        return;
+    }
+#else
+    (void)aligned;
+#endif
+    std::free(p);
+}
+
+ImFlowBench::AllocCount ImFlowBench::alloc_count() noexcept
+{
+    return {s_count.load(std::memory_order_relaxed), s_bytes.load(std::memory_order_relaxed)};
+}
+
+void* operator new(std::size_t size)
+{
+    if (void* p = counted_alloc(size, 0))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align)
+{
+    if (void* p = counted_alloc(size, static_cast<std::size_t>(align)))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t align)
+{
+    return ::operator new(size, align);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return counted_alloc(size, 0);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return counted_alloc(size, 0);
+}
+
+void operator delete(void* p) noexcept { counted_free(p, false); }
+void operator delete[](void* p) noexcept { counted_free(p, false); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p, false); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p, false); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_free(p, true); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_free(p, true); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { counted_free(p, true); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { counted_free(p, true); }
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ImFlowBench
+{
+    /**
+     * @brief Heap activity since the start of the program
+     */
+    struct AllocCount
+    {
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+    };
+
+    /**
+     * @brief <BR>Read the global allocation counters
+     * @details Counted by the replacement of the global operator new, linked into every benchmark executable.
+     * @return Number and size of the allocations so far
+     */
+    AllocCount alloc_count() noexcept;
+
+    inline AllocCount operator-(const AllocCount& a, const AllocCount& b) noexcept
+    { return {a.count - b.count, a.bytes - b.bytes}; }
+}
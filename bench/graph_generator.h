@@ -0,0 +1,205 @@
+#pragma once
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <ImNodeFlow.h>
+
+namespace ImFlowBench
+{
+    /**
+     * @brief <BR>Get the behaviour counter
+     * @details Incremented by every output behaviour of the generated nodes: a machine-independent measure of the evaluation work.
+     * @return Reference to the counter
+     */
+    inline std::atomic<uint64_t>& behaviour_calls() noexcept
+    {
+        static std::atomic<uint64_t> calls = 0;
+        return calls;
+    }
+
+    /**
+     * @brief Node of the synthetic graphs: each output sums the inputs, the body shows the first output
+     */
+    class BenchNode : public ImFlow::BaseNode
+    {
+    public:
+        BenchNode(int ins, int outs)
+        {
+            setTitle("Bench");
+            for (int i = 0; i < ins; i++)
+                m_ins.push_back(addIN<float>("in" + std::to_string(i), 1.f, ImFlow::ConnectionFilter::SameType()));
+            for (int o = 0; o < outs; o++)
+                m_outs.push_back(addOUT<float>("out" + std::to_string(o))->behaviour([this, o]()
+                {
+                    behaviour_calls().fetch_add(1, std::memory_order_relaxed);
+                    float sum = static_cast<float>(o);
+                    for (auto &in: m_ins) { sum += in->val(); }
+                    return sum * 0.5f;
+                }));
+        }
+
+        void draw() noexcept override
+        {
+            if (!m_outs.empty())
+                ImGui::Text("%.2f", m_outs.front()->val());
+        }
+
+        [[nodiscard]] const std::vector<std::shared_ptr<ImFlow::InPin<float>>>& ins() const noexcept { return m_ins; }
+        [[nodiscard]] const std::vector<ImFlow::OutPin<float>*>& outs() const noexcept { return m_outs; }
+
+    protected:
+        std::vector<std::shared_ptr<ImFlow::InPin<float>>>  m_ins;
+        std::vector<ImFlow::OutPin<float>*>                 m_outs;
+    };
+
+    /**
+     * @brief Node with dynamic pins: besides its static input and output, shows inputs and an output every frame
+     */
+    class DynamicNode : public BenchNode
+    {
+    public:
+        explicit DynamicNode(int dynamicIns) : BenchNode(1, 1), m_dynamicIns(dynamicIns)
+        { setTitle("Dynamic"); }
+
+        void draw() noexcept override
+        {
+            float sum = m_outs.front()->val();
+            for (int i = 0; i < m_dynamicIns; i++)
+                sum += showIN<float>("dyn" + std::to_string(i), 1.f, ImFlow::ConnectionFilter::SameType());
+            m_sum = sum;
+            showOUT<float>("dyn_out", [this]()
+            {
+                behaviour_calls().fetch_add(1, std::memory_order_relaxed);
+                return m_sum;
+            });
+            ImGui::Text("%.2f", sum);
+        }
+
+    private:
+        int   m_dynamicIns;
+        float m_sum = 0.f;
+    };
+
+    /**
+     * @brief Topology of a generated graph
+     */
+    enum GraphShape
+    {
+        GraphShape_WideDag,    // Inputs link to random outputs of the previous [window] nodes
+        GraphShape_Chain,      // Each node reads the previous one
+        GraphShape_Tree,       // Each node has [fanOut] children, one per output
+        GraphShape_FanOut,     // Few sources, each output read by about a thousand inputs
+        GraphShape_DynamicPins // Chain of nodes showing [fanIn] dynamic inputs and a dynamic output every frame
+    };
+
+    /**
+     * @brief Parameters of a generated graph
+     */
+    struct GraphSpec
+    {
+        std::size_t nodes = 1000;
+        int         fanIn = 2;    // Inputs per node
+        int         fanOut = 1;   // Outputs per node
+        std::size_t window = 64;  // Inputs connect to the previous [window] nodes
+        uint32_t    seed = 1;
+        GraphShape  shape = GraphShape_WideDag;
+    };
+
+    /**
+     * @brief Result of a generation
+     */
+    struct GeneratedGraph
+    {
+        std::vector<std::shared_ptr<BenchNode>> nodes;
+        std::size_t                             links = 0;
+    };
+
+    /**
+     * @brief <BR>Get the name of a shape
+     * @param shape Shape of the graph
+     * @return Name, as used in the benchmark results
+     */
+    inline const char* shape_name(GraphShape shape) noexcept
+    {
+        switch (shape)
+        {
+            case GraphShape_WideDag: return "wide_dag";
+            case GraphShape_Chain: return "chain";
+            case GraphShape_Tree: return "tree";
+            case GraphShape_FanOut: return "fan_out";
+            case GraphShape_DynamicPins: return "dynamic_pins";
+        }
+        return "unknown";
+    }
+
+    /**
+     * @brief <BR>Generate a random graph
+     * @details Every graph is acyclic: inputs only link to nodes created before. Nodes are laid out in columns of 32,
+     *          most of them off-screen for large graphs. The same spec always produces the same graph.
+     *          <BR> Dynamic pins exist only once drawn, so they are left unconnected.
+     * @param inf Handler to populate
+     * @param spec Size, shape and seed
+     * @return Created nodes and number of links
+     */
+    inline GeneratedGraph generate(ImFlow::ImNodeFlow& inf, const GraphSpec& spec)
+    {
+        std::mt19937 rng(spec.seed);
+        GeneratedGraph g;
+        g.nodes.reserve(spec.nodes);
+        int fanIn = std::max(spec.fanIn, 1);
+        int fanOut = std::max(spec.fanOut, 1);
+        std::size_t sources = std::max<std::size_t>(1, spec.nodes / 1000);
+
+        auto link = [&](BenchNode* node, std::size_t input, BenchNode* src, std::size_t output)
+        {
+            node->ins()[input]->createLink(src->outs()[output % src->outs().size()]);
+            g.links++;
+        };
+
+        for (std::size_t i = 0; i < spec.nodes; i++)
+        {
+            ImVec2 pos(static_cast<float>(i / 32) * 220.f, static_cast<float>(i % 32) * 90.f);
+            std::shared_ptr<BenchNode> node;
+            switch (spec.shape)
+            {
+                case GraphShape_WideDag:
+                    node = inf.addNode<BenchNode>(pos, fanIn, fanOut);
+                    for (std::size_t k = 0; i > 0 && k < node->ins().size(); k++)
+                    {
+                        std::size_t src = i - 1 - rng() % std::min(i, spec.window);
+                        link(node.get(), k, g.nodes[src].get(), rng());
+                    }
+                    break;
+                case GraphShape_Chain:
+                    node = inf.addNode<BenchNode>(pos, 1, 1);
+                    if (i > 0)
+                        link(node.get(), 0, g.nodes[i - 1].get(), 0);
+                    break;
+                case GraphShape_Tree:
+                    node = inf.addNode<BenchNode>(pos, 1, fanOut);
+                    if (i > 0)
+                        link(node.get(), 0, g.nodes[(i - 1) / fanOut].get(), (i - 1) % fanOut);
+                    break;
+                case GraphShape_FanOut:
+                    node = inf.addNode<BenchNode>(pos, i < sources ? 0 : fanIn, fanOut);
+                    for (std::size_t k = 0; i >= sources && k < node->ins().size(); k++)
+                    {
+                        std::size_t src = rng() % sources;
+                        link(node.get(), k, g.nodes[src].get(), rng());
+                    }
+                    break;
+                case GraphShape_DynamicPins:
+                    node = inf.addNode<DynamicNode>(pos, fanIn);
+                    if (i > 0)
+                        link(node.get(), 0, g.nodes[i - 1].get(), 0);
+                    break;
+            }
+            g.nodes.push_back(std::move(node));
+        }
+        return g;
+    }
+}
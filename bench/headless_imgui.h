@@ -0,0 +1,85 @@
+#pragma once
+
+#include <imgui.h>
+
+namespace ImFlowBench
+{
+    /**
+     * @brief Dear ImGui context with a null backend
+     * @details No window and no GPU: the display size is fixed, the font atlas is built on the CPU and texture
+     *          requests are acknowledged without uploading anything. Frames are complete, draw data included.
+     */
+    class HeadlessImGui
+    {
+    public:
+        /**
+         * @brief <BR>Create and make current the context
+         * @param display Size of the fake display
+         */
+        explicit HeadlessImGui(ImVec2 display = ImVec2(1920.f, 1080.f))
+        {
+            m_ctx = ImGui::CreateContext();
+            ImGuiIO& io = ImGui::GetIO();
+            io.DisplaySize = display;
+            io.DeltaTime = 1.f / 60.f;
+            io.IniFilename = nullptr;
+            io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+#ifdef IMGUI_HAS_TEXTURES
+            io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+#else
+            unsigned char* pixels;
+            int w, h;
+            io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+#endif
+        }
+
+        ~HeadlessImGui() { ImGui::DestroyContext(m_ctx); }
+
+        HeadlessImGui(const HeadlessImGui&) = delete;
+        HeadlessImGui& operator=(const HeadlessImGui&) = delete;
+
+        /**
+         * @brief <BR>Start a frame and a full-display window to host the editor
+         */
+        void beginFrame()
+        {
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+            ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+            ImGui::Begin("bench", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove);
+        }
+
+        /**
+         * @brief <BR>End the frame and render it
+         * @return Draw data of the frame
+         */
+        ImDrawData* endFrame()
+        {
+            ImGui::End();
+            ImGui::Render();
+            ImDrawData* data = ImGui::GetDrawData();
+#ifdef IMGUI_HAS_TEXTURES
+            if (data->Textures)
+                for (ImTextureData* tex : *data->Textures)
+                {
+                    if (tex->Status == ImTextureStatus_WantCreate)
+                    {
+                        tex->SetTexID(static_cast<ImTextureID>(1));
+                        tex->SetStatus(ImTextureStatus_OK);
+                    }
+                    else if (tex->Status == ImTextureStatus_WantUpdates)
+                        tex->SetStatus(ImTextureStatus_OK);
+                    else if (tex->Status == ImTextureStatus_WantDestroy && tex->UnusedFrames > 0)
+                    {
+                        tex->SetTexID(ImTextureID_Invalid);
+                        tex->SetStatus(ImTextureStatus_Destroyed);
+                    }
+                }
+#endif
+            return data;
+        }
+
+    private:
+        ImGuiContext* m_ctx;
+    };
+}
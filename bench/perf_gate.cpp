@@ -0,0 +1,234 @@
+/**
+ * Performance regression gate, run by CTest.
+ *
+ * Usage: ImNodeFlowPerfGate --baseline file [--metrics counters|timings|all|name,...] [--nodes 10000] [--frames 20] [--budget-ms 0] [--record]
+ *
+ * Every graph shape of graph_generator.h is generated with [nodes] nodes and updated for [frames] frames.
+ * Counters (vertices, allocations, library allocations and behaviour calls per frame) are machine-independent and deterministic:
+ * they catch redundant work, lost culling and heap churn exactly. Library allocations are those of the thread calling update(),
+ * checked to be counted at all on a probe graph first. Timings are only compared with a loose tolerance.
+ *
+ * The baseline is a text file, one metric per line: "<shape>.<metric> <value> <tolerance>", '#' starts a comment.
+ * A metric fails when it exceeds value * (1 + tolerance) (plus half a unit for counters). A counter missing from the
+ * baseline fails too: select the recorded ones by name (e.g. "allocs,behaviour_calls"). Timings missing from the baseline
+ * are only checked against --budget-ms. --record rewrites the selected metrics of the baseline from the current run.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <ImNodeFlow.h>
+#include "alloc_counter.h"
+#include "headless_imgui.h"
+#include "graph_generator.h"
+
+using namespace ImFlowBench;
+using Clock = std::chrono::steady_clock;
+
+struct Metric
+{
+    std::string name;
+    double      value;
+    bool        timing;
+};
+
+struct Baseline
+{
+    double value;
+    double tolerance;
+};
+
+// "counters", "timings", "all", or a comma-separated list of metric names without the shape
+static bool selected(const std::string& which, const Metric& m)
+{
+    if (which == "all")
+        return true;
+    if (which == "counters" || which == "timings")
+        return m.timing == (which == "timings");
+    std::string name = m.name.substr(m.name.find('.') + 1);
+    std::istringstream list(which);
+    for (std::string item; std::getline(list, item, ',');)
+        if (item == name)
+            return true;
+    return false;
+}
+
+static std::vector<Metric> measure(HeadlessImGui& gui, GraphShape shape, std::size_t nodes, int frames)
+{
+    ImFlow::ImNodeFlow inf(shape_name(shape));
+    GeneratedGraph g = generate(inf, {nodes, 2, 2, 64, 1, shape});
+
+    for (int i = 0; i < 3; i++)
+    {
+        gui.beginFrame();
+        inf.update();
+        gui.endFrame();
+    }
+
+    std::vector<double> updates;
+    updates.reserve(frames);
+    uint64_t vertices = 0, libraryAllocs = 0;
+    AllocCount allocStart = alloc_count();
+    uint64_t callsStart = behaviour_calls();
+    for (int i = 0; i < frames; i++)
+    {
+        gui.beginFrame();
+        auto t = Clock::now();
+        inf.update();
+        updates.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t).count());
+        vertices += gui.endFrame()->TotalVtxCount;
+        libraryAllocs += inf.getFrameAllocations().totalCount();
+    }
+    AllocCount allocs = alloc_count() - allocStart;
+    uint64_t calls = behaviour_calls() - callsStart;
+
+    std::sort(updates.begin(), updates.end());
+    auto n = static_cast<double>(frames);
+    std::string s = shape_name(shape);
+    return {
+        {s + ".vertices", static_cast<double>(vertices) / n, false},
+        {s + ".allocs", static_cast<double>(allocs.count) / n, false},
+        {s + ".alloc_bytes", static_cast<double>(allocs.bytes) / n, false},
+        {s + ".library_allocs", static_cast<double>(libraryAllocs) / n, false},
+        {s + ".behaviour_calls", static_cast<double>(calls) / n, false},
+        {s + ".update_ms", updates[updates.size() / 2], true}
+    };
+}
+
+static std::map<std::string, Baseline> load(const std::string& path)
+{
+    std::map<std::string, Baseline> b;
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);)
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream ls(line);
+        std::string name;
+        Baseline v{};
+        if (ls >> name >> v.value >> v.tolerance)
+            b[name] = v;
+    }
+    return b;
+}
+
+static void record(const std::string& path, const std::vector<Metric>& metrics, const std::map<std::string, Baseline>& old)
+{
+    // The header comment and the metrics that weren't measured this time are kept
+    std::string header;
+    {
+        std::ifstream in(path);
+        for (std::string line; std::getline(in, line) && !line.empty() && line[0] == '#';)
+            header += line + "\n";
+    }
+    if (header.empty())
+        header = "# ImNodeFlowPerfGate baseline: <shape>.<metric> <value> <tolerance>\n"
+                 "# Regenerate with: ImNodeFlowPerfGate --baseline <this file> --metrics counters --record\n";
+
+    std::ofstream out(path);
+    out << header;
+    for (auto &m: metrics)
+    {
+        auto it = old.find(m.name);
+        double tolerance = it != old.end() ? it->second.tolerance : (m.timing ? 0.5 : 0.05);
+        out << m.name << " " << m.value << " " << tolerance << "\n";
+    }
+    for (auto &b: old)
+    {
+        if (std::none_of(metrics.begin(), metrics.end(), [&b](const Metric& m) { return m.name == b.first; }))
+            out << b.first << " " << b.second.value << " " << b.second.tolerance << "\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string baselinePath, which = "all";
+    std::size_t nodes = 10000;
+    int frames = 20;
+    double budgetMs = 0.;
+    bool rec = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string a = argv[i];
+        if (a == "--record") { rec = true; continue; }
+        if (i + 1 >= argc)
+            break;
+        std::string v = argv[++i];
+        if (a == "--baseline") baselinePath = v;
+        else if (a == "--metrics") which = v;
+        else if (a == "--nodes") nodes = std::stoul(v);
+        else if (a == "--frames") frames = std::max(std::stoi(v), 1);
+        else if (a == "--budget-ms") budgetMs = std::stod(v);
+    }
+    if (baselinePath.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " --baseline file [--metrics counters|timings|all|name,...] [--nodes N] [--frames N] [--budget-ms X] [--record]\n";
+        return 2;
+    }
+
+    HeadlessImGui gui;
+
+    // The library counters must see a graph being built, or the zero library allocations gated below prove nothing
+    {
+        ImFlow::AllocStats start = ImFlow::thread_allocation_stats();
+        ImFlow::ImNodeFlow probe("probe");
+        (void)generate(probe, {64, 2, 2, 64, 1, GraphShape_WideDag});
+        if ((ImFlow::thread_allocation_stats() - start).totalCount() == 0)
+        {
+            std::cerr << "The library allocations are not counted\n";
+            return 1;
+        }
+    }
+
+    std::vector<Metric> metrics;
+    for (GraphShape s: {GraphShape_WideDag, GraphShape_Chain, GraphShape_Tree, GraphShape_FanOut, GraphShape_DynamicPins})
+    {
+        auto m = measure(gui, s, nodes, frames);
+        metrics.insert(metrics.end(), m.begin(), m.end());
+    }
+    std::erase_if(metrics, [&which](const Metric& m) { return !selected(which, m); });
+
+    std::map<std::string, Baseline> baseline = load(baselinePath);
+    if (rec)
+    {
+        record(baselinePath, metrics, baseline);
+        std::cout << "Baseline written to " << baselinePath << "\n";
+        return 0;
+    }
+
+    int failures = 0;
+    for (auto &m: metrics)
+    {
+        std::printf("%-32s %14.3f", m.name.c_str(), m.value);
+        bool failed = false;
+        if (m.timing && budgetMs > 0. && m.value > budgetMs)
+        {
+            std::printf("  over budget of %.3f ms", budgetMs);
+            failed = true;
+        }
+        auto it = baseline.find(m.name);
+        if (it == baseline.end())
+        {
+            // A counter without baseline would pass whatever it measures
+            std::printf("  (no baseline)");
+            failed |= !m.timing;
+        }
+        else
+        {
+            double limit = it->second.value * (1. + it->second.tolerance) + (m.timing ? 0. : 0.5);
+            std::printf("  baseline %14.3f  limit %14.3f", it->second.value, limit);
+            if (m.value > limit)
+                failed = true;
+            else if (m.value < it->second.value * (1. - it->second.tolerance))
+                std::printf("  improved, consider --record");
+        }
+        std::printf("%s\n", failed ? "  FAILED" : "");
+        failures += failed;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+/**
+ * Synchronization round trip, run by CTest.
+ *
+ * Usage: ImNodeFlowSyncRoundTrip
+ *
+ * A source graph with a Journal and a ChangeTracker attached is edited, then undone and redone step by step.
+ * After each step the tracked changes are applied to a peer, which must end up with the same nodes (UIDs and
+ * positions) and links. The peer's own changes are sent back to check that applying them to the source is a no-op.
+ * Finally, a journal fed only by patches must recover the same graph.
+ */
+
+#include <cstdio>
+#include <filesystem>
+#include <set>
+#include <tuple>
+#include <ImNodeFlow.h>
+#include "journal.h"
+#include "graph_patch.h"
+#include "headless_imgui.h"
+
+using namespace ImFlowBench;
+
+namespace
+{
+    class SyncNode : public ImFlow::BaseNode
+    {
+    public:
+        SyncNode()
+        {
+            setTitle("sync");
+            (void)addIN<float>("in", 0.f, ImFlow::ConnectionFilter::None());
+            (void)addOUT<float>("out")->behaviour([this]() { return getInVal<float>("in") + 1.f; });
+        }
+
+        void draw() noexcept override {}
+    };
+
+    using LinkSet = std::set<std::tuple<uint64_t, uint64_t, uint64_t, uint64_t>>;
+
+    LinkSet links_of(ImFlow::ImNodeFlow& inf)
+    {
+        LinkSet s;
+        for (auto& l : inf.getLinks())
+            if (auto link = l.lock())
+            {
+                ImFlow::LinkKey k = ImFlow::LinkKey::of(*link);
+                s.emplace(k.outNode, k.outPin, k.inNode, k.inPin);
+            }
+        return s;
+    }
+
+    bool same(ImFlow::ImNodeFlow& a, ImFlow::ImNodeFlow& b)
+    {
+        if (a.getNodes().size() != b.getNodes().size() || links_of(a) != links_of(b))
+            return false;
+        for (auto& [uid, n] : a.getNodes())
+        {
+            auto it = b.getNodes().find(uid);
+            if (it == b.getNodes().end() || n->getPos().x != it->second->getPos().x || n->getPos().y != it->second->getPos().y)
+                return false;
+        }
+        return true;
+    }
+}
+
+IMFLOW_REGISTER_NODE(SyncNode, 0x53594E43);
+
+#define EXPECT(cond) do { if (!(cond)) { std::fprintf(stderr, "sync_roundtrip: %s failed (line %d)\n", #cond, __LINE__); return 1; } } while (0)
+
+int main()
+{
+    HeadlessImGui gui;
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::string path = (dir / "imnodeflow_sync_roundtrip.journal").string();
+    std::string replica = (dir / "imnodeflow_sync_replica.journal").string();
+    std::filesystem::remove(path);
+    std::filesystem::remove(replica);
+
+    {
+        ImFlow::ImNodeFlow src("source"), peer("peer");
+        ImFlow::Journal journal(src, path);
+        ImFlow::ChangeTracker changes(src);
+        auto sync = [&]() { return changes.take().apply(peer) && same(src, peer); };
+
+        // Edits, one undo step each
+        src.beginEdit();
+        auto a = src.addNode<SyncNode>({0, 0});
+        auto b = src.addNode<SyncNode>({200, 0});
+        b->inPin("in")->createLink(a->outPin("out"));
+        src.endEdit();
+        EXPECT(sync());
+
+        src.beginEdit();
+        auto c = src.addNode<SyncNode>({400, 0});
+        c->inPin("in")->createLink(b->outPin("out"));
+        src.endEdit();
+        EXPECT(sync());
+
+        ImVec2 from = b->getPos();
+        b->setPos({200, 100});
+        src.nodeMoved(b.get(), from);
+        EXPECT(sync());
+
+        ImFlow::NodeUID bUid = b->getUID();
+        b = nullptr;
+        EXPECT(src.removeNode(bUid));
+        EXPECT(sync());
+
+        // Undo everything, then redo everything: restored nodes keep their UIDs and links
+        int steps = 0;
+        while (journal.undo())
+        {
+            EXPECT(sync());
+            steps++;
+        }
+        EXPECT(steps == 4 && src.getNodes().empty());
+        while (journal.redo())
+        {
+            EXPECT(sync());
+            steps--;
+        }
+        EXPECT(steps == 0 && src.getNodes().size() == 2 && !src.getNodes().count(bUid));
+
+        // Echo: the peer's own changes applied back to the source change nothing
+        ImFlow::ChangeTracker echo(peer);
+        EXPECT(journal.undo());
+        EXPECT(sync());
+        EXPECT(peer.getNodes().count(bUid) && links_of(peer).size() == 2);
+        EXPECT(echo.take().apply(src) && same(src, peer));
+
+        // A journal fed only by patches recovers the same graph
+        {
+            ImFlow::ImNodeFlow fed("fed");
+            ImFlow::Journal fedJournal(fed, replica);
+            EXPECT(ImFlow::GraphSnapshot().diff(src).apply(fed) && same(src, fed));
+        }
+        ImFlow::ImNodeFlow recovered("recovered");
+        ImFlow::Journal recoveredJournal(recovered, replica);
+        EXPECT(recoveredJournal.recover() && same(src, recovered));
+    }
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(replica);
+    std::printf("sync_roundtrip: ok\n");
+    return 0;
+}
@@ -2,7 +2,7 @@
 FetchContent_Declare(
   ImGui
   GIT_REPOSITORY    https://github.com/ocornut/imgui.git
-  GIT_TAG           master # master
+  GIT_TAG           v1.92.1 # Pinned: the perf gate baselines depend on the Dear ImGui version
   GIT_SHALLOW       TRUE
 )
 
@@ -8,12 +8,33 @@
 #include <vector>
 #include <cmath>
 #include <memory>
+#include <span>
+#include <array>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <ostream>
 #include <algorithm>
 #include <functional>
 #include <unordered_map>
+#include <atomic>
+#include <optional>
+#include <typeinfo>
+#include <concepts>
+#include <stop_token>
 #include <imgui.h>
 #include "imgui_bezier_math.h"
 #include "context_wrapper.h"
+#include "thread_pool.h"
+#include "node_task.h"
+#include "command_queue.h"
+#include "event_queue.h"
+#include "profiler.h"
+#include "trace.h"
+#include "allocator.h"
+#include "memory_stats.h"
+#include "graph_observer.h"
 
 //#define ConnectionFilter_None       [](ImFlow::Pin* out, ImFlow::Pin* in){ return true; }
 //#define ConnectionFilter_SameType   [](ImFlow::Pin* out, ImFlow::Pin* in){ return out->getDataType() == in->getDataType(); }
@@ -47,6 +68,22 @@ namespace ImFlow
      */
     inline static bool smart_bezier_collider(const ImVec2& p, const ImVec2& p1, const ImVec2& p2, float radius);
 
+    /**
+     * @brief <BR>Tint a color towards red by a cost ratio
+     * @param color Base color
+     * @param heat Ratio between 0 (base color) and 1 (red)
+     * @return Tinted color
+     */
+    inline static ImU32 heat_tint(ImU32 color, float heat);
+
+    /**
+     * @brief <BR>Mix a hash into a running seed
+     * @param seed Running hash, updated in place
+     * @param h Hash to be mixed in
+     */
+    constexpr void hash_combine(std::size_t& seed, std::size_t h) noexcept(true)
+    { seed ^= h + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2); }
+
     // -----------------------------------------------------------------------------------------------------------------
     // CLASSES PRE-DEFINITIONS
 
@@ -54,12 +91,54 @@ namespace ImFlow
     template<typename T> class OutPin;
     class Pin; class BaseNode;
     class ImNodeFlow; class ConnectionFilter;
+    class BlockIO; class BatchIO;
+    struct BlockPlan; class GraphInstances;
+    class PagedGraph;
+    class NodeRegistry; class JsonReader;
+
+    /**
+     * @brief <BR>Get the process-wide registry
+     * @details Defined with NodeRegistry in "node_registry.h", to include for registering types or using the registry.
+     * @return Reference to the registry filled by IMFLOW_REGISTER_NODE
+     */
+    NodeRegistry& node_registry();
+
+    /**
+     * @brief <BR>Get the stable type ID of a node, for saving
+     */
+    using NodeTypeOf = std::function<uint32_t(const BaseNode& node)>;
+
+    /**
+     * @brief <BR>Create a node from its type ID, for loading
+     * @details Must add the node to the handler (e.g. with addNode<T>()). Return nullptr to skip the node and its links.
+     */
+    using NodeFactory = std::function<std::shared_ptr<BaseNode>(ImNodeFlow& inf, uint32_t type, const ImVec2& pos)>;
+
+    /**
+     * @brief <BR>List of the static pins of a node
+     */
+    using PinList = std::vector<std::shared_ptr<Pin>, TaggedAllocator<std::shared_ptr<Pin>, AllocTag_Pins>>;
 
     // -----------------------------------------------------------------------------------------------------------------
     // PIN'S PROPERTIES
 
     typedef unsigned long long int PinUID;
 
+    /**
+     * @brief Copy of the value of an input, kept by memoized outputs to check their cache hits
+     */
+    struct HeldValue
+    {
+        PinUID                      pin = 0;
+        const std::type_info*       type = nullptr;
+        std::shared_ptr<const void> value;
+    };
+
+    /**
+     * @brief <BR>Copies of the values of a node's inputs, in the order of BaseNode::hashIns()
+     */
+    using HeldValues = std::vector<HeldValue, TaggedAllocator<HeldValue, AllocTag_Evaluation>>;
+
     /**
      * @brief Extra pin's style setting
      */
@@ -206,9 +285,11 @@ namespace ImFlow
          * @param left Pointer to the output Pin of the Link
          * @param right Pointer to the input Pin of the Link
          * @param inf Pointer to the Handler that contains the Link
+         * @param cyclic [TRUE] if the link closes a cycle in the graph
+         * @param delayed [TRUE] if the link starts from a delay output
          */
-        constexpr explicit Link(Pin* left, Pin* right, ImNodeFlow* inf) noexcept(true)
-          : m_left(left), m_right(right), m_inf(inf), m_hovered(false), m_selected(false)
+        constexpr explicit Link(Pin* left, Pin* right, ImNodeFlow* inf, bool cyclic = false, bool delayed = false) noexcept(true)
+          : m_left(left), m_right(right), m_inf(inf), m_hovered(false), m_selected(false), m_cyclic(cyclic), m_delayed(delayed)
         {}
 
         /**
@@ -251,12 +332,40 @@ namespace ImFlow
         [[nodiscard]] constexpr bool isSelected() const noexcept(true)
         { return m_selected; }
 
+        /**
+         * @brief <BR>Get cyclic status
+         * @details Cyclic links are only created when the handler allows cycles, and are ignored by the topological order.
+         *          The flag is cleared once the removal of another link breaks the cycle.
+         * @return [TRUE] If the link closes a cycle in the graph
+         */
+        [[nodiscard]] constexpr bool isCyclic() const noexcept(true)
+        { return m_cyclic; }
+
+        /**
+         * @brief <BR>Get delayed status
+         * @details Delayed links carry the value of the previous evaluation pass, so they are not an evaluation dependency.
+         * @return [TRUE] If the link starts from a delay output
+         */
+        [[nodiscard]] constexpr bool isDelayed() const noexcept(true)
+        { return m_delayed; }
+
+        /**
+         * @brief <BR>Get dependency status
+         * @return [TRUE] If the right node must be evaluated after the left one. (Neither cyclic nor delayed)
+         */
+        [[nodiscard]] constexpr bool isDependency() const noexcept(true)
+        { return !m_cyclic && !m_delayed; }
+
     private:
+        friend class ImNodeFlow;
+
         Pin*        m_left;
         Pin*        m_right;
         ImNodeFlow* m_inf;
         bool        m_hovered;
         bool        m_selected;
+        bool        m_cyclic;
+        bool        m_delayed;
     };
 
     // -----------------------------------------------------------------------------------------------------------------
@@ -390,12 +499,509 @@ namespace ImFlow
         template<typename T, typename... Params>
         std::shared_ptr<T> placeNode(Params&&... args) noexcept(true);
 
+        /**
+         * @brief <BR>Destruction of the editor
+         * @details Releases the nodes while the handler is still whole, so that links can unregister themselves.
+         */
+        ~ImNodeFlow();
+
         /**
          * @brief <BR>Add link to the handler internal list
+         * @details Also records the link in the adjacency lists of the two connected nodes.
          * @param link Reference to the link
          */
         void addLink(std::shared_ptr<Link>& link) noexcept(true);
 
+        /**
+         * @brief <BR>Remove a link from the nodes adjacency lists
+         * @details Called by the link itself on destruction.
+         * @param link Pointer to the link being destroyed
+         */
+        void removeLink(Link* link) noexcept(true);
+
+        /**
+         * @brief <BR>Register an observer of the structural edits
+         * @param observer Pointer to the observer, must be removed before being destroyed
+         */
+        void addObserver(GraphObserver* observer)
+        { m_observers.push_back(observer); }
+
+        /**
+         * @brief <BR>Unregister an observer
+         * @param observer Pointer to the observer
+         */
+        void removeObserver(GraphObserver* observer)
+        { m_observers.erase(std::remove(m_observers.begin(), m_observers.end(), observer), m_observers.end()); }
+
+        /**
+         * @brief <BR>Get the registered observers
+         * @return Const reference to the list of observers
+         */
+        [[nodiscard]] constexpr const std::vector<GraphObserver*>& getObservers() const noexcept(true)
+        { return m_observers; }
+
+        /**
+         * @brief <BR>Start a group of edits forming one user action
+         * @details Reported to the observers: e.g. undone at once by a Journal. Must be balanced by endEdit().
+         */
+        void beginEdit()
+        { for (auto* o: m_observers) o->editBegin(); }
+
+        /**
+         * @brief <BR>End a group of edits
+         */
+        void endEdit()
+        { for (auto* o: m_observers) o->editEnd(); }
+
+        /**
+         * @brief <BR>Report the end of a node drag
+         * @details Called by the node itself, and by whatever moves nodes programmatically for the observers to see it.
+         * @param node Pointer to the node, at its new position
+         * @param from Position before the drag
+         */
+        void nodeMoved(BaseNode* node, const ImVec2& from)
+        { for (auto* o: m_observers) o->nodeMoved(*node, from); }
+
+        /**
+         * @brief <BR>Remove a node now
+         * @details Unlike BaseNode::destroy(), doesn't wait for the next update() and ignores onDestroy().
+         *          Must not be called from within update() (e.g. from a node's draw()).
+         * @param uid UID of the node
+         * @return [FALSE] if there's no such node
+         */
+        bool removeNode(NodeUID uid);
+
+        /**
+         * @brief <BR>Change the UID of a node
+         * @details Keeps the lookup table of the handler in sync, unlike BaseNode::setUID() once the node is added.
+         *          The change isn't reported to the observers: to restore a node with its UID, use setNextNodeUID().
+         * @param uid Current UID of the node
+         * @param newUid New UID
+         * @return [FALSE] if there's no such node, or the new UID is taken
+         */
+        bool changeNodeUID(NodeUID uid, NodeUID newUid);
+
+        /**
+         * @brief <BR>Give its UID to the next node added
+         * @details The node is added, and reported to the observers, under this UID instead of one derived from its address.
+         * @param uid UID of the next node, 0 to cancel
+         * @return [FALSE] if the UID is taken
+         */
+        bool setNextNodeUID(NodeUID uid) noexcept(true);
+
+        /**
+         * @brief <BR>Set the UIDs that new nodes must not take
+         * @details E.g. the UIDs of the nodes paged out by a PagedGraph, which come back with them.
+         * @param reserved Predicate on a UID, empty for none
+         */
+        void setReservedUIDs(std::function<bool(NodeUID)> reserved)
+        { m_reservedUIDs = std::move(reserved); }
+
+        /**
+         * @brief <BR>Set the pager holding the nodes that aren't in getNodes()
+         * @details Called by PagedGraph. Writers of the whole graph, like Journal::checkpoint(), read its pages too.
+         * @param pages Pointer to the pager, nullptr for none
+         */
+        void setPagedGraph(PagedGraph* pages) noexcept(true)
+        { m_pagedGraph = pages; }
+
+        /**
+         * @brief <BR>Get the pager of the graph
+         * @return Pointer to the PagedGraph paging nodes out, nullptr if there's none
+         */
+        [[nodiscard]] PagedGraph* getPagedGraph() const noexcept(true)
+        { return m_pagedGraph; }
+
+        /**
+         * @brief <BR>Fit a new link in the topological order of the nodes
+         * @details Incremental check (Pearce-Kelly): only the nodes between the two endpoints in the current order are visited,
+         *          and they are reordered if needed. Nothing is changed if the link would close a cycle.
+         * @param left Output pin of the new link
+         * @param right Input pin of the new link
+         * @return [FALSE] if the link would close a cycle
+         */
+        bool orderLink(Pin* left, Pin* right) noexcept(true);
+
+        /**
+         * @brief <BR>Allow links that close a cycle
+         * @details When disabled (default) links that would close a cycle are rejected.
+         *          When enabled they are created and flagged as cyclic, and the values along the cycle lag one frame behind.
+         * @param state New state of the flag
+         */
+        constexpr void allowCycles(bool state) noexcept(true)
+        { m_allowCycles = state; }
+
+        /**
+         * @brief <BR>Get cycles policy
+         * @return [TRUE] if links closing a cycle are allowed
+         */
+        [[nodiscard]] constexpr bool cyclesAllowed() const noexcept(true)
+        { return m_allowCycles; }
+
+        /**
+         * @brief <BR>Get acyclic status
+         * @return [TRUE] if no cyclic link is present in the graph
+         */
+        [[nodiscard]] constexpr bool isAcyclic() const noexcept(true)
+        { return m_cyclicLinks.empty(); }
+
+        /**
+         * @brief <BR>Add a delay output to the handler internal list
+         * @details Delay outputs are resolved and committed together by finishEvaluation().
+         * @param pin Reference to the delay output
+         */
+        void addDelay(const std::shared_ptr<Pin>& pin) noexcept(true);
+
+        /**
+         * @brief <BR>Close the current evaluation pass
+         * @details Resolves every delay output from the values of this pass, then commits them all at once,
+         *          so that the next pass reads them regardless of the order the nodes are visited in.
+         *          Finally advances the evaluation frame. Called at the end of each update.
+         */
+        void finishEvaluation() noexcept(true);
+
+        /**
+         * @brief <BR>Enable sink-driven evaluation
+         * @details When enabled only the nodes marked as sinks, and the nodes they transitively depend on, are evaluated.
+         *          Outputs of every other node keep their last value without running their behaviour.
+         * @param state New state of the flag
+         */
+        inline void sinkDriven(bool state) noexcept(true)
+        { m_sinkDriven = state; m_planDirty = true; }
+
+        /**
+         * @brief <BR>Get sink-driven evaluation status
+         * @return [TRUE] if only the sinks and their dependencies are evaluated
+         */
+        [[nodiscard]] constexpr bool isSinkDriven() const noexcept(true)
+        { return m_sinkDriven; }
+
+        /**
+         * @brief <BR>Evaluate the sinks
+         * @details Resolves the outputs of the nodes in the evaluation plan, in topological order.
+         *          Called at the start of each update when sink-driven evaluation is enabled.
+         *          <BR> Without update(), call finishEvaluation() afterwards to close the pass.
+         */
+        void evaluate() noexcept(true);
+
+        /**
+         * @brief <BR>Get the evaluation plan
+         * @details Sinks and their transitive upstream nodes in topological order.
+         *          Cached until the links, the nodes or the sinks change.
+         * @return View over the plan
+         */
+        std::span<BaseNode* const> getEvaluationPlan() noexcept(true);
+
+        /**
+         * @brief <BR>Invalidate the cached evaluation plan
+         */
+        constexpr void invalidatePlan() noexcept(true)
+        { m_planDirty = true; }
+
+        /**
+         * @brief <BR>Get the generation of the evaluation plan
+         * @details Nodes in the plan are marked with the generation it was built in.
+         * @return Counter of the plan rebuilds
+         */
+        [[nodiscard]] constexpr uint32_t getPlanEpoch() const noexcept(true)
+        { return m_planEpoch; }
+
+        /**
+         * @brief <BR>Get the background executor
+         * @details Runs asynchronous behaviours. Started the first time it is requested.
+         * @return Reference to the handler's thread pool
+         */
+        ThreadPool& getExecutor() noexcept(true);
+
+        /**
+         * @brief <BR>Get the coroutine scheduler
+         * @details Resumes the suspended coroutine behaviours. Ticked at the start of each update.
+         * @return Reference to the handler's scheduler
+         */
+        constexpr TaskScheduler& getScheduler() noexcept(true)
+        { return m_scheduler; }
+
+        /**
+         * @brief <BR>Start evaluating the graph on a dedicated thread
+         * @details Each pass evaluates every node (or the plan when sink-driven), then publishes all the output values at once.
+         *          While the evaluator runs, output pins read during update() return the latest published pass instead of evaluating,
+         *          and update() no longer closes the passes itself.
+         *          <BR> update() draws the nodes without the graph lock, alongside the behaviours, so draw() and the behaviours must not share unguarded state.
+         *          It only takes the graph for its structural phases: posted commands and coroutines first, then the staged edits, pop-ups and deleted nodes.
+         *          The evaluator hands the graph over between two nodes, and restarts its pass if the graph changed.
+         *          <BR> When the evaluator is stuck in a slow node past the wait, the structural phases are left to the next frame.
+         * @param period Minimum duration of a pass. Zero runs passes back to back
+         * @param wait Longest time update() waits for the evaluator to hand the graph over
+         */
+        void startEvaluator(std::chrono::microseconds period = std::chrono::microseconds(0),
+                            std::chrono::microseconds wait = std::chrono::milliseconds(2));
+
+        /**
+         * @brief <BR>Stop the evaluator thread
+         * @details Waits for the running pass to end. Evaluation goes back to update().
+         */
+        void stopEvaluator();
+
+        /**
+         * @brief <BR>Get evaluator status
+         * @return [TRUE] if the graph is evaluated on a dedicated thread
+         */
+        [[nodiscard]] bool isEvaluatorRunning() const noexcept(true)
+        { return m_evaluator.joinable(); }
+
+        /**
+         * @brief <BR>Take the graph from the evaluator thread
+         * @details Taken by update() for its structural phases, or for the whole frame when the evaluator isn't running.
+         *          Hold it on the UI thread to change the graph outside of update(), or on any thread to read the current pin values
+         *          while the evaluator runs. Never take it from draw().
+         * @return Lock on the graph
+         */
+        [[nodiscard]] std::unique_lock<std::mutex> lockGraph();
+
+        /**
+         * @brief <BR>Take the graph from the evaluator thread, for a limited time
+         * @details Like lockGraph(), but gives up if the evaluator is still in the same node after the wait.
+         * @param wait Longest time to wait for the evaluator to hand the graph over
+         * @return Lock on the graph. Not owned if the wait expired
+         */
+        [[nodiscard]] std::unique_lock<std::mutex> tryLockGraph(std::chrono::microseconds wait);
+
+        /**
+         * @brief <BR>Post a graph mutation from any thread
+         * @details Lock-free. Commands are applied in posting order at the start of the next update(), on the UI thread.
+         *          Commands still queued when the handler is destroyed are dropped.
+         * @tparam F Type of the function or lambda expression
+         * @param fn Function or lambda expression called with the handler. Must only use data it owns
+         * @return Future of the value returned by the function
+         */
+        template<typename F>
+        auto post(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>&, ImNodeFlow&>>;
+
+        /**
+         * @brief <BR>Post the creation of a node from any thread
+         * @details The node is constructed on the UI thread, see addNode().
+         * @tparam T Derived class of <BaseNode> to be added
+         * @tparam Params types of optional args to forward to derived class ctor
+         * @param pos Position of the new node
+         * @param args Optional arguments to be forwarded to derived class ctor. Copied or moved into the command
+         * @return Future of the shared pointer to the new node
+         */
+        template<typename T, typename... Params>
+        std::future<std::shared_ptr<T>> postNode(const ImVec2& pos, Params&&... args);
+
+        /**
+         * @brief <BR>Post the creation of a link from any thread
+         * @param left Node owning the output pin
+         * @param outUid Unique identifier of the output pin
+         * @param right Node owning the input pin
+         * @param inUid Unique identifier of the input pin
+         * @return Future of the new link. Empty if a node or a pin is gone, or if the link was rejected
+         */
+        std::future<std::weak_ptr<Link>> postLink(std::weak_ptr<BaseNode> left, std::string outUid,
+                                                  std::weak_ptr<BaseNode> right, std::string inUid);
+
+        /**
+         * @brief <BR>Post the destruction of a node from any thread
+         * @param node Node to destroy. Ignored if already gone
+         * @return Future set once the node is marked for destruction
+         */
+        std::future<void> postDestroy(std::weak_ptr<BaseNode> node);
+
+        /**
+         * @brief <BR>Enable block processing
+         * @details The block processors (see BaseNode::blockProcess()) are compiled into a plan on the UI thread,
+         *          recompiled during update() whenever nodes or links change, and handed over to processBlock() atomically.
+         * @param size Number of samples per block. Set to 0 to disable
+         */
+        void setBlockSize(std::size_t size) noexcept(true);
+
+        /**
+         * @brief <BR>Get block size
+         * @return Number of samples per block, 0 if block processing is disabled
+         */
+        [[nodiscard]] constexpr std::size_t getBlockSize() const noexcept(true)
+        { return m_blockSize; }
+
+        /**
+         * @brief <BR>Compile the block plan again at the next update
+         * @details Needed when a node starts or stops being a block processor, or to sample the constant inputs again.
+         */
+        constexpr void invalidateBlockPlan() noexcept(true)
+        { m_blockVersion = ~m_graphVersion; }
+
+        /**
+         * @brief <BR>Process one block
+         * @details Real-time safe: neither allocates nor locks. Adopts the latest compiled plan, then runs its nodes in topological order.
+         *          Must always be called from the same thread.
+         */
+        void processBlock() noexcept(true);
+
+        /**
+         * @brief <BR>Create instances of the graph for batch evaluation
+         * @details The batch processors (see BaseNode::batchProcess()) are taken in topological order, and each of their pins
+         *          gets a column of values. Unconnected inputs, and inputs fed by other nodes, start with their current value.
+         *          <BR> Only pins of trivially copyable types get a column. GraphInstances is declared in graph_instances.h.
+         * @param count Number of instances
+         * @return Instances, ready to be evaluated
+         */
+        GraphInstances instantiate(std::size_t count);
+
+        /**
+         * @brief <BR>Enable the profiler
+         * @details Records self time and call count of each output behaviour and each node's draw(), with the steady clock.
+         *          Time spent evaluating other outputs from inside a call is excluded from it. Nothing is allocated.
+         * @param state New state of the flag
+         */
+        constexpr void profile(bool state) noexcept(true)
+        { m_profiling = state; }
+
+        /**
+         * @brief <BR>Get profiler status
+         * @return [TRUE] if the profiler is recording
+         */
+        [[nodiscard]] constexpr bool isProfiling() const noexcept(true)
+        { return m_profiling; }
+
+        /**
+         * @brief <BR>Show the profiler heat-map
+         * @details Node headers are tinted towards red by their share of the cost of the most expensive node.
+         * @param state New state of the flag
+         */
+        constexpr void profileOverlay(bool state) noexcept(true)
+        { m_profileOverlay = state; }
+
+        /**
+         * @brief <BR>Get profiler heat-map status
+         * @return [TRUE] if node headers are tinted by cost
+         */
+        [[nodiscard]] constexpr bool isProfileOverlay() const noexcept(true)
+        { return m_profileOverlay; }
+
+        /**
+         * @brief <BR>Get cost of the most expensive node
+         * @details Updated at the end of each update.
+         * @return Evaluation plus draw time in nanoseconds
+         */
+        [[nodiscard]] constexpr uint64_t getProfileMax() const noexcept(true)
+        { return m_profileMax; }
+
+        /**
+         * @brief <BR>Get counter of nested profiled time
+         * @details Shared by the ProfileScope of nested calls. One per thread: the evaluator and update() time their calls apart.
+         * @return Reference to the counter
+         */
+        static uint64_t& profileChildren() noexcept(true)
+        {
+            static thread_local uint64_t children = 0;
+            return children;
+        }
+
+        /**
+         * @brief <BR>Clear every recorded cost
+         */
+        void resetProfile() noexcept(true);
+
+        /**
+         * @brief <BR>Get the most expensive nodes
+         * @param n Maximum number of nodes
+         * @return Profiles of the nodes, most expensive first
+         */
+        [[nodiscard]] std::vector<NodeProfile> topNodes(std::size_t n);
+
+        /**
+         * @brief <BR>Print the most expensive nodes
+         * @param out Stream to print the table to
+         * @param n Maximum number of nodes
+         */
+        void dumpProfile(std::ostream& out, std::size_t n);
+
+        /**
+         * @brief <BR>Get allocations of the last frame
+         * @details Allocations made by the library during the last update(), per subsystem (see set_allocator()).
+         *          Only the calling thread is counted: the evaluator, the executor and the other threads allocating meanwhile are not included.
+         * @return Count and bytes of the allocations
+         */
+        [[nodiscard]] constexpr const AllocStats& getFrameAllocations() const noexcept(true)
+        { return m_frameAllocs; }
+
+        /**
+         * @brief <BR>Measure the memory held by the graph
+         * @details Walks every node, pin and link, and the draw buffers of the editor. Not thread-safe: while the evaluator runs, hold lockGraph().
+         * @return Bytes per category
+         */
+        [[nodiscard]] MemoryStats memoryStats();
+
+        /**
+         * @brief <BR>Save the graph to a binary file
+         * @details Stores the nodes with their type ID, position, title and input defaults, and the links.
+         *          Default values are stored only for trivially copyable types, links to dynamic pins aren't restored.
+         * @param path Path of the file, overwritten
+         * @param typeOf Gives the type ID of each node
+         * @return [FALSE] if the file couldn't be written
+         */
+        bool saveBinary(const std::string& path, const NodeTypeOf& typeOf);
+
+        /**
+         * @brief <BR>Add the nodes and links of a binary file to the graph
+         * @details The file is memory-mapped and read in one pass. Loaded nodes keep their UIDs, unless already taken in the graph.
+         * @param path Path of the file
+         * @param factory Creates each node from its type ID
+         * @return [FALSE] if the file couldn't be mapped or isn't a graph file
+         */
+        bool loadBinary(const std::string& path, const NodeFactory& factory);
+
+        /**
+         * @brief <BR>Save the graph to a binary file, with the type IDs and node states of a registry
+         * @details Nodes of unregistered types are stored as NodeRegistry::unknown, and skipped when loading.
+         * @param path Path of the file, overwritten
+         * @param registry Registry of the node types
+         * @return [FALSE] if the file couldn't be written
+         */
+        bool saveBinary(const std::string& path, const NodeRegistry& registry = node_registry());
+
+        /**
+         * @brief <BR>Add the nodes and links of a binary file to the graph, created and restored by a registry
+         * @param path Path of the file
+         * @param registry Registry of the node types
+         * @return [FALSE] if the file couldn't be mapped or isn't a graph file
+         */
+        bool loadBinary(const std::string& path, const NodeRegistry& registry = node_registry());
+
+        /**
+         * @brief <BR>Write the graph as JSON
+         * @details Streams the nodes (UID, type, title, position, pins with their defaults, state) then the links, one per line.
+         * @param out Stream to write to
+         * @param registry Registry of the node types
+         * @return [FALSE] if the stream failed
+         */
+        bool exportJson(std::ostream& out, const NodeRegistry& registry = node_registry());
+
+        /**
+         * @brief <BR>Add the nodes and links of a JSON document to the graph
+         * @details Parses the stream incrementally and creates each node as soon as it is read.
+         *          The node UIDs of the document are remapped to the created nodes: links must come after their nodes.
+         * @param in Stream to read from
+         * @param registry Registry of the node types
+         * @return [FALSE] on malformed input. What was read before the error stays in the graph
+         */
+        bool importJson(std::istream& in, const NodeRegistry& registry = node_registry());
+
+        /**
+         * @brief <BR>Get snapshot reading status
+         * @details Set per thread: the evaluator thread keeps running the behaviours while update() reads the snapshot.
+         *          Pins shown and links edited meanwhile are staged until the structural phase at the end of update().
+         * @return [TRUE] on the thread running update() while the evaluator runs: output pins return the published values
+         */
+        [[nodiscard]] bool readsSnapshot() const noexcept(true)
+        { return m_snapshotReader == this; }
+
+        /**
+         * @brief <BR>Get the snapshot slot read by update()
+         * @return Index of the front slot
+         */
+        [[nodiscard]] constexpr uint8_t getSnapshotSlot() const noexcept(true)
+        { return m_snapshotFront; }
+
         /**
          * @brief <BR>Pop-up when link is "dropped"
          * @details Sets the content of a pop-up that can be displayed when dragging a link in the open instead of onto another pin.
@@ -524,6 +1130,15 @@ namespace ImFlow
         constexpr void hoveredNode(BaseNode* hovering) noexcept(true)
         { m_hoveredNode = hovering; }
 
+        /**
+         * @brief <BR>Link or unlink two pins in the structural phase at the end of update()
+         * @details Used by the editor while it draws without the graph lock. The edit is dropped if a pin or its node left the graph in the meantime.
+         * @param from Pin the link is dragged from
+         * @param to Pin the link is dropped on
+         * @param create [TRUE] to link the pins like a drop of "from" on "to", [FALSE] to delete the link from output "from" to input "to"
+         */
+        void postLinkEdit(Pin* from, Pin* to, bool create);
+
         /**
          * @brief <BR>Convert coordinates from screen to grid
          * @param p Point in screen coordinates to be converted
@@ -551,20 +1166,157 @@ namespace ImFlow
         bool on_free_space() noexcept(true);
 
         /**
-         * @brief <BR>Get recursion blacklist for nodes
-         * @return Reference to blacklist
+         * @brief <BR>Get current evaluation frame
+         * @details Output pins compute their value at most once per evaluation frame. The frame advances at the end of each update.
+         * @return Counter of the evaluation frame
          */
-        constexpr std::vector<std::string>& get_recursion_blacklist() noexcept(true)
-        { return m_pinRecursionBlacklist; }
+        [[nodiscard]] constexpr uint64_t getEvalFrame() const noexcept(true)
+        { return m_evalFrame; }
     private:
+        /**
+         * @brief <BR>Body of the evaluator thread
+         */
+        void evaluatorLoop(const std::stop_token& stop, std::chrono::microseconds period);
+
+        /**
+         * @brief <BR>Store the output values and evaluation cost of a node in a snapshot slot
+         */
+        void publish(BaseNode* node, uint8_t slot) noexcept(true);
+
+        /**
+         * @brief <BR>Fill every snapshot slot of a node with its current values
+         * @details Allocates the snapshots of the outputs. Only under the graph lock, while update() doesn't draw.
+         */
+        void seed(BaseNode* node);
+
+        /**
+         * @brief <BR>Apply the link edits staged during the frame
+         */
+        void applyLinkEdits();
+
+        /**
+         * @brief <BR>Build the block plan of the current graph
+         * @return New plan, owned by the caller. Release it with tagged_delete<AllocTag_Evaluation>()
+         */
+        BlockPlan* compileBlockPlan();
+
+        /**
+         * @brief <BR>Write a binary graph file
+         * @param saveState Appends the state of a node. Optional
+         */
+        bool writeBinary(const std::string& path, const NodeTypeOf& typeOf, const std::function<void(const BaseNode&, std::vector<std::byte>&)>& saveState);
+
+        /**
+         * @brief <BR>Read a binary graph file
+         * @param loadState Restores the state of a node. Optional
+         */
+        bool readBinary(const std::string& path, const NodeFactory& factory, const std::function<bool(BaseNode&, std::span<const std::byte>)>& loadState);
+
+        /**
+         * @brief <BR>Get the nodes in topological order
+         * @return Pointers to the nodes, upstream first
+         */
+        std::vector<BaseNode*> sortedNodes();
+
+        /**
+         * @brief <BR>Drop the links of a node, report and remove it
+         * @param it Position of the node in the lookup table
+         * @return Position of the next node
+         */
+        std::unordered_map<NodeUID, std::shared_ptr<BaseNode>>::iterator eraseNode(std::unordered_map<NodeUID, std::shared_ptr<BaseNode>>::iterator it);
+
+        /**
+         * @brief <BR>Read the members of a JSON document, after its opening brace
+         * @param remap Document UIDs of the nodes read so far
+         */
+        bool readJsonDocument(JsonReader& r, const NodeRegistry& registry, std::unordered_map<NodeUID, BaseNode*>& remap);
+
+        /**
+         * @brief <BR>Read a node object of a JSON document, after its opening brace
+         * @param remap Document UIDs of the nodes read so far
+         */
+        bool readJsonNode(JsonReader& r, const NodeRegistry& registry, std::unordered_map<NodeUID, BaseNode*>& remap);
+
+        /**
+         * @brief <BR>Read a link object of a JSON document, after its opening brace
+         * @param remap Document UIDs of the nodes read so far
+         */
+        bool readJsonLink(JsonReader& r, const std::unordered_map<NodeUID, BaseNode*>& remap);
+
+        /**
+         * @brief <BR>Record a change of the nodes or the links
+         */
+        constexpr void graphChanged() noexcept(true)
+        { m_planDirty = true; m_graphVersion++; }
+
         const std::string m_name;
         ContainedContext  m_context;
 
         bool m_singleUseClick = false;
 
+        // Topology bookkeeping, declared before the nodes as links unregister while the nodes are destroyed
+        uint32_t m_nextTopoIndex = 0;
+        uint32_t m_visitEpoch = 0;
+        bool     m_allowCycles = false;
+        std::vector<Link*, TaggedAllocator<Link*, AllocTag_Graph>>         m_cyclicLinks;
+        std::vector<BaseNode*, TaggedAllocator<BaseNode*, AllocTag_Graph>> m_orderForward;
+        std::vector<BaseNode*, TaggedAllocator<BaseNode*, AllocTag_Graph>> m_orderBackward;
+        std::vector<BaseNode*, TaggedAllocator<BaseNode*, AllocTag_Graph>> m_orderStack;
+        std::vector<uint32_t, TaggedAllocator<uint32_t, AllocTag_Graph>>   m_orderPool;
+
+        uint64_t m_evalFrame = 1;
+        std::vector<std::weak_ptr<Pin>, TaggedAllocator<std::weak_ptr<Pin>, AllocTag_Evaluation>> m_delays;
+
+        bool m_sinkDriven = false;
+        bool m_planDirty = true;
+        uint32_t m_planEpoch = 0;
+        std::vector<BaseNode*, TaggedAllocator<BaseNode*, AllocTag_Evaluation>> m_plan;
+
+        TaggedPtr<ThreadPool, AllocTag_Evaluation> m_executor;
+        TaskScheduler               m_scheduler;
+
+        // Triple buffer: the evaluator writes the back slot then swaps it with the middle one, update() swaps the front one with the middle one
+        std::mutex           m_graphMutex;
+        std::atomic<int>     m_graphWaiters = 0;
+        std::atomic<uint8_t> m_snapshotMiddle = 1;
+        uint8_t              m_snapshotFront = 0;
+        uint8_t              m_snapshotBack = 2;
+        inline static thread_local const ImNodeFlow* m_snapshotReader = nullptr;
+        std::chrono::microseconds m_graphWait{0};
+        uint64_t             m_graphVersion = 0;
+        std::vector<BaseNode*, TaggedAllocator<BaseNode*, AllocTag_Evaluation>> m_passNodes;
+        std::jthread         m_evaluator;
+
+        // Link edits of a frame drawn without the graph lock. Pins are held weakly: they may leave the graph before the edit applies
+        struct LinkEdit
+        {
+            std::pair<std::weak_ptr<BaseNode>, std::weak_ptr<Pin>> from;
+            std::pair<std::weak_ptr<BaseNode>, std::weak_ptr<Pin>> to;
+            bool create;
+        };
+        std::vector<LinkEdit, TaggedAllocator<LinkEdit, AllocTag_Links>> m_linkEdits;
+
+        CommandQueue m_commands;
+
+        // Block plans travel UI -> processing thread through m_blockPending, and back through m_blockRetired to be freed
+        std::size_t             m_blockSize = 0;
+        uint64_t                m_blockVersion = 0;
+        BlockPlan*              m_blockActive = nullptr;
+        std::atomic<BlockPlan*> m_blockPending = nullptr;
+        std::atomic<BlockPlan*> m_blockRetired = nullptr;
+
+        bool     m_profiling = false;
+        bool     m_profileOverlay = false;
+        uint64_t m_profileMax = 0;
+
+        AllocStats m_frameAllocs;
+
         std::unordered_map<NodeUID, std::shared_ptr<BaseNode>> m_nodes;
-        std::vector<std::string> m_pinRecursionBlacklist;
         std::vector<std::weak_ptr<Link>> m_links;
+        std::vector<GraphObserver*> m_observers;
+        std::function<bool(NodeUID)> m_reservedUIDs;
+        NodeUID m_nextNodeUID = 0;
+        PagedGraph* m_pagedGraph = nullptr;
 
         std::function<void(Pin* dragged)> m_droppedLinkPopUp;
         ImGuiKey m_droppedLinkPupUpComboKey = ImGuiKey_None;
@@ -659,6 +1411,7 @@ namespace ImFlow
          * @brief <BR>Show a temporary input pin
          * @details Will show an input pin with the given name.
          *          The pin is created the first time showIN is called and kept alive as long as showIN is called each frame.
+         *          While the evaluator runs, new pins are staged until the structural phase at the end of ImNodeFlow::update().
          *          <BR> <BR> In this case the name of the pin will also be its UID.
          *          <BR> <BR> The UID must be unique only in the context of the current node's inputs.
          * @tparam T Type of the data the pin will handle
@@ -675,6 +1428,7 @@ namespace ImFlow
          * @brief <BR>Show a temporary input pin
          * @details Will show an input pin with the given name and UID.
          *          The pin is created the first time showIN_uid is called and kept alive as long as showIN_uid is called each frame.
+         *          While the evaluator runs, new pins are staged until the structural phase at the end of ImNodeFlow::update().
          *          <BR> <BR> The UID must be unique only in the context of the current node's inputs.
          * @tparam T Type of the data the pin will handle
          * @tparam U Type of the UID
@@ -717,6 +1471,35 @@ namespace ImFlow
         template<typename T, typename U>
         [[nodiscard]] std::shared_ptr<OutPin<T>> addOUT_uid(const U& uid, const std::string& name, std::shared_ptr<PinStyle> style = nullptr) noexcept(true);
 
+        /**
+         * @brief <BR>Add a delay Output to the node
+         * @details Will add an Output pin that outputs the value its behaviour produced in the previous evaluation pass (one-frame delay).
+         *          <BR> <BR> Links from a delay output are not evaluation dependencies, so they can close a feedback loop.
+         *          <BR> <BR> In this case the name of the pin will also be its UID.
+         * @tparam T Type of the data the pin will handle
+         * @param name Name of the pin
+         * @param initial Value output before the first pass is committed
+         * @param style Style of the pin
+         * @return Shared pointer to the newly added pin. Must be used to set the behaviour
+         */
+        template<typename T>
+        [[nodiscard]] std::shared_ptr<OutPin<T>> addDelayOUT(const std::string& name, T initial, std::shared_ptr<PinStyle> style = nullptr) noexcept(true);
+
+        /**
+         * @brief <BR>Add a delay Output to the node
+         * @details Will add an Output pin that outputs the value its behaviour produced in the previous evaluation pass (one-frame delay).
+         *          <BR> <BR> Links from a delay output are not evaluation dependencies, so they can close a feedback loop.
+         * @tparam T Type of the data the pin will handle
+         * @tparam U Type of the UID
+         * @param uid Unique identifier of the pin
+         * @param name Name of the pin
+         * @param initial Value output before the first pass is committed
+         * @param style Style of the pin
+         * @return Shared pointer to the newly added pin. Must be used to set the behaviour
+         */
+        template<typename T, typename U>
+        [[nodiscard]] std::shared_ptr<OutPin<T>> addDelayOUT_uid(const U& uid, const std::string& name, T initial, std::shared_ptr<PinStyle> style = nullptr) noexcept(true);
+
         /**
          * @brief <BR>Remove output pin
          * @tparam U Type of the UID
@@ -735,6 +1518,7 @@ namespace ImFlow
          * @brief <BR>Show a temporary output pin
          * @details Will show an output pin with the given name.
          *          The pin is created the first time showOUT is called and kept alive as long as showOUT is called each frame.
+         *          While the evaluator runs, new pins and behaviours are staged until the structural phase at the end of ImNodeFlow::update().
          *          <BR> <BR> In this case the name of the pin will also be its UID.
          *          <BR> <BR> The UID must be unique only in the context of the current node's outputs.
          * @tparam T Type of the data the pin will handle
@@ -750,6 +1534,7 @@ namespace ImFlow
          * @brief <BR>Show a temporary output pin
          * @details Will show an output pin with the given name.
          *          The pin is created the first time showOUT_uid is called and kept alive as long as showOUT_uid is called each frame.
+         *          While the evaluator runs, new pins and behaviours are staged until the structural phase at the end of ImNodeFlow::update().
          *          <BR> <BR> The UID must be unique only in the context of the current node's outputs.
          * @tparam T Type of the data the pin will handle
          * @tparam U Type of the UID
@@ -805,29 +1590,174 @@ namespace ImFlow
          * @param uid Unique identifier of the pin
          * @return Generic pointer to the pin
          */
-        template<typename U>
-        [[nodiscard]] Pin* outPin(const U& uid) noexcept(true);
+        template<typename U>
+        [[nodiscard]] Pin* outPin(const U& uid) noexcept(true);
+
+        /**
+         * @brief <BR>Get generic reference to output pin
+         * @param uid Unique identifier of the pin
+         * @return Generic pointer to the pin
+         */
+        [[nodiscard]] Pin* outPin(const char* uid) noexcept(true);
+
+        /**
+         * @brief <BR>Get internal input pins list
+         * @return Const reference to node's internal list
+         */
+        [[nodiscard]] const PinList& getIns() noexcept(true)
+        { return m_ins; }
+
+        /**
+         * @brief <BR>Get internal output pins list
+         * @return Const reference to node's internal list
+         */
+        [[nodiscard]] const PinList& getOuts() noexcept(true)
+        { return m_outs; }
+
+        /**
+         * @brief <BR>Hash the current values of the inputs
+         * @details Combines the value of each static input, then the UID and value of each dynamic input, into the seed.
+         *          Reading the values resolves the connected outputs.
+         * @param seed Running hash, updated in place
+         * @return [FALSE] if one of the inputs holds a value that can't be hashed
+         */
+        [[nodiscard]] bool hashIns(std::size_t& seed) noexcept(true);
+
+        /**
+         * @brief <BR>Copy the current values of the inputs
+         * @param out Copies, one for each static then dynamic input
+         * @return [FALSE] if one of the inputs holds a value that can't be copied or compared
+         */
+        [[nodiscard]] bool holdIns(HeldValues& out) noexcept(true);
+
+        /**
+         * @brief <BR>Compare the current values of the inputs to copies taken by holdIns()
+         * @param held Copies of the values
+         * @return [TRUE] if the node has the same inputs, holding equal values
+         */
+        [[nodiscard]] bool matchIns(const HeldValues& held) noexcept(true);
+
+        /**
+         * @brief <BR>Get the nodes feeding this node
+         * @details One entry for each link connected to one of the node's inputs, in no particular order.
+         *          <BR> A node connected through multiple links is listed once per link.
+         * @return View over the upstream nodes
+         */
+        [[nodiscard]] std::span<BaseNode* const> upstream() const noexcept(true)
+        { return m_upstream; }
+
+        /**
+         * @brief <BR>Get the nodes fed by this node
+         * @details One entry for each link connected to one of the node's outputs, in no particular order.
+         *          <BR> A node connected through multiple links is listed once per link.
+         * @return View over the downstream nodes
+         */
+        [[nodiscard]] std::span<BaseNode* const> downstream() const noexcept(true)
+        { return m_downstream; }
+
+        /**
+         * @brief <BR>Get the links connected to the node's inputs
+         * @return View over the links, index-aligned with upstream()
+         */
+        [[nodiscard]] std::span<Link* const> upstreamLinks() const noexcept(true)
+        { return m_upstreamLinks; }
+
+        /**
+         * @brief <BR>Get the links connected to the node's outputs
+         * @return View over the links, index-aligned with downstream()
+         */
+        [[nodiscard]] std::span<Link* const> downstreamLinks() const noexcept(true)
+        { return m_downstreamLinks; }
+
+        /**
+         * @brief <BR>Get node's position in the topological order
+         * @details Every non-cyclic link goes from a lower to a higher index. Indexes are not contiguous.
+         * @return Topological index of the node
+         */
+        [[nodiscard]] constexpr uint32_t getTopoIndex() const noexcept(true)
+        { return m_topoIndex; }
+
+        /**
+         * @brief <BR>Mark the node as a sink
+         * @details With sink-driven evaluation, sinks and their dependencies are the only nodes evaluated.
+         * @param state New state of the flag
+         */
+        BaseNode* setSink(bool state) noexcept(true);
+
+        /**
+         * @brief <BR>Get sink status
+         * @return [TRUE] if the node is a sink
+         */
+        [[nodiscard]] constexpr bool isSink() const noexcept(true)
+        { return m_sink; }
+
+        /**
+         * @brief <BR>Get live status
+         * @details Always [TRUE] unless sink-driven evaluation is enabled on the handler.
+         * @return [TRUE] if the node is part of the evaluation plan
+         */
+        [[nodiscard]] bool isLive() const noexcept(true);
+
+        /**
+         * @brief <BR>Set block processing logic
+         * @details Called by ImNodeFlow::processBlock() once per block, on the processing thread, with a buffer for each
+         *          input and output of type Sample. Inputs not fed by another block processor read a constant buffer,
+         *          sampled from the input's value when the plan is compiled.
+         *          <BR> Must not allocate, lock, or touch data the UI thread changes without synchronization.
+         *          BlockIO is declared in block_plan.h.
+         * @param process Function or lambda expression reading the input buffers and writing the output ones
+         * @return Pointer to this node
+         */
+        BaseNode* blockProcess(std::function<void(const BlockIO&)> process)
+        { m_blockProcess = std::move(process); return this; }
+
+        /**
+         * @brief <BR>Get block processing status
+         * @return [TRUE] if the node has block processing logic
+         */
+        [[nodiscard]] bool isBlockProcessor() const noexcept(true)
+        { return static_cast<bool>(m_blockProcess); }
+
+        /**
+         * @brief <BR>Set batch processing logic
+         * @details Called by GraphInstances::evaluate() with a column of values per pin, to process many instances of the graph at once.
+         *          BatchIO is declared in graph_instances.h.
+         * @param process Function or lambda expression reading the input columns and writing the output ones
+         * @return Pointer to this node
+         */
+        BaseNode* batchProcess(std::function<void(const BatchIO&)> process)
+        { m_batchProcess = std::move(process); return this; }
 
         /**
-         * @brief <BR>Get generic reference to output pin
-         * @param uid Unique identifier of the pin
-         * @return Generic pointer to the pin
+         * @brief <BR>Get batch processing status
+         * @return [TRUE] if the node has batch processing logic
          */
-        [[nodiscard]] Pin* outPin(const char* uid) noexcept(true);
+        [[nodiscard]] bool isBatchProcessor() const noexcept(true)
+        { return static_cast<bool>(m_batchProcess); }
 
         /**
-         * @brief <BR>Get internal input pins list
-         * @return Const reference to node's internal list
+         * @brief <BR>Get evaluation cost
+         * @details Sum of the self time of the node's output behaviours, while the profiler records.
+         * @return Reference to the stats
          */
-        [[nodiscard]] const std::vector<std::shared_ptr<Pin>>& getIns() noexcept(true)
-        { return m_ins; }
+        constexpr ProfileStats& getEvalStats() noexcept(true)
+        { return m_evalStats; }
 
         /**
-         * @brief <BR>Get internal output pins list
-         * @return Const reference to node's internal list
+         * @brief <BR>Get evaluation cost as update() sees it
+         * @details While the evaluator runs, the cost recorded up to the published pass.
+         * @return Reference to the stats
          */
-        [[nodiscard]] const std::vector<std::shared_ptr<Pin>>& getOuts() noexcept(true)
-        { return m_outs; }
+        [[nodiscard]] const ProfileStats& getShownEvalStats() const noexcept(true)
+        { return m_inf && m_inf->readsSnapshot() ? m_evalPublished[m_inf->getSnapshotSlot()] : m_evalStats; }
+
+        /**
+         * @brief <BR>Get drawing cost
+         * @details Self time of draw(), while the profiler records.
+         * @return Reference to the stats
+         */
+        constexpr ProfileStats& getDrawStats() noexcept(true)
+        { return m_drawStats; }
 
         /**
          * @brief <BR>Delete itself
@@ -961,6 +1891,22 @@ namespace ImFlow
          */
         void updatePublicStatus() { m_selected = m_selectedNext; }
     private:
+        friend class ImNodeFlow;
+        friend class NodeRegistry;
+        friend class PagedGraph;
+
+        /**
+         * @brief <BR>Measure the node, its pins and its adjacency lists
+         * @param walk Walk the bytes are added to
+         */
+        void memoryUsage(MemoryWalk& walk) const;
+
+        /**
+         * @brief <BR>Drop the temporary pins that weren't shown, and add the staged ones
+         * @details Run by ImNodeFlow::update() under the graph lock.
+         */
+        void sweepPins();
+
         NodeUID m_uid = 0;
         std::string m_title;
         ImVec2 m_pos, m_posTarget;
@@ -969,12 +1915,31 @@ namespace ImFlow
         std::shared_ptr<NodeStyle> m_style;
         bool m_selected = false, m_selectedNext = false;
         bool m_dragged = false;
+        bool m_moving = false;
+        ImVec2 m_moveStart;
         bool m_destroyed = false;
 
-        std::vector<std::shared_ptr<Pin>> m_ins;
-        std::vector<std::pair<int, std::shared_ptr<Pin>>> m_dynamicIns;
-        std::vector<std::shared_ptr<Pin>> m_outs;
-        std::vector<std::pair<int, std::shared_ptr<Pin>>> m_dynamicOuts;
+        // Declared before the pins: links unregister from both nodes while the pins are being destroyed
+        std::vector<BaseNode*, TaggedAllocator<BaseNode*, AllocTag_Graph>> m_upstream;
+        std::vector<Link*, TaggedAllocator<Link*, AllocTag_Graph>>         m_upstreamLinks;
+        std::vector<BaseNode*, TaggedAllocator<BaseNode*, AllocTag_Graph>> m_downstream;
+        std::vector<Link*, TaggedAllocator<Link*, AllocTag_Graph>>         m_downstreamLinks;
+        uint32_t m_topoIndex = 0;
+        uint32_t m_visitMark = 0;
+        uint32_t m_planMark = 0;
+        bool m_sink = false;
+        std::function<void(const BlockIO&)> m_blockProcess;
+        std::function<void(const BatchIO&)> m_batchProcess;
+        ProfileStats m_evalStats;
+        ProfileStats m_drawStats;
+        std::array<ProfileStats, 3> m_evalPublished{};
+        std::size_t m_footprint = sizeof(BaseNode);
+
+        PinList m_ins;
+        std::vector<std::pair<int, std::shared_ptr<Pin>>, TaggedAllocator<std::pair<int, std::shared_ptr<Pin>>, AllocTag_Pins>> m_dynamicIns;
+        PinList m_outs;
+        std::vector<std::pair<int, std::shared_ptr<Pin>>, TaggedAllocator<std::pair<int, std::shared_ptr<Pin>>, AllocTag_Pins>> m_dynamicOuts;
+        std::vector<std::pair<int, std::shared_ptr<Pin>>, TaggedAllocator<std::pair<int, std::shared_ptr<Pin>>, AllocTag_Pins>> m_stagedPins;
     };
 
     // -----------------------------------------------------------------------------------------------------------------
@@ -1039,6 +2004,106 @@ namespace ImFlow
          */
         virtual void resolve() noexcept(true) = 0;
 
+        /**
+         * @brief <BR>Used by delay output pins to publish the value calculated by resolve()
+         */
+        virtual void commit() noexcept(true) {}
+
+        /**
+         * @brief <BR>Used by output pins to store their value in a snapshot slot
+         * @param slot Index of the slot
+         */
+        virtual void publish([[maybe_unused]] uint8_t slot) noexcept(true) {}
+
+        /**
+         * @brief <BR>Used by output pins to allocate their snapshot and fill every slot with their value
+         */
+        virtual void seedSnapshot() {}
+
+        /**
+         * @brief <BR>Used by output pins to take the behaviour staged while the evaluator ran
+         */
+        virtual void swapBehaviour() noexcept(true) {}
+
+        /**
+         * @brief <BR>Get the size of a value in a batch column
+         * @return Size of the data type. 0 if it can't be stored in a column
+         */
+        [[nodiscard]] virtual std::size_t columnSize() const noexcept(true)
+        { return 0; }
+
+        /**
+         * @brief <BR>Fill a batch column with the current value of the pin
+         * @param dst Start of the column
+         * @param count Number of values
+         */
+        virtual void fillColumn([[maybe_unused]] std::byte* dst, [[maybe_unused]] std::size_t count) noexcept(true) {}
+
+        /**
+         * @brief <BR>Clear the profiler stats of the pin
+         */
+        virtual void resetStats() noexcept(true) {}
+
+        /**
+         * @brief <BR>Measure the pin
+         * @param walk Walk the bytes are added to
+         */
+        virtual void memoryUsage(MemoryWalk& walk) const
+        { countMemory(walk, sizeof(*this)); }
+
+        /**
+         * @brief <BR>Get the default value as raw bytes
+         * @return Value returned while unconnected. Empty for outputs and types that aren't trivially copyable
+         */
+        [[nodiscard]] virtual std::span<const std::byte> defaultBytes() const noexcept(true)
+        { return {}; }
+
+        /**
+         * @brief <BR>Set the default value from raw bytes
+         * @param bytes Bytes returned by defaultBytes()
+         * @return [FALSE] if the size doesn't match the data type
+         */
+        virtual bool setDefaultBytes(std::span<const std::byte> bytes) noexcept(true)
+        { return bytes.empty(); }
+
+        /**
+         * @brief <BR>Get delay status
+         * @return [TRUE] if the pin outputs the value of the previous evaluation pass
+         */
+        [[nodiscard]] virtual bool isDelay() const noexcept(true)
+        { return false; }
+
+        /**
+         * @brief <BR>Hash the current value of the pin
+         * @param seed Running hash the value's hash is combined into
+         * @return [FALSE] if the value can't be hashed
+         */
+        [[nodiscard]] virtual bool hashValue([[maybe_unused]] std::size_t& seed) noexcept(true)
+        { return false; }
+
+        /**
+         * @brief <BR>Copy the current value of the pin
+         * @param out Copies to append the pin's to
+         * @return [FALSE] if the value can't be copied or compared
+         */
+        [[nodiscard]] virtual bool holdValue([[maybe_unused]] HeldValues& out) noexcept(true)
+        { return false; }
+
+        /**
+         * @brief <BR>Compare the current value of the pin to a copy
+         * @param held Copy taken by holdValue()
+         * @return [TRUE] if the copy was taken from this pin, and is equal to its value
+         */
+        [[nodiscard]] virtual bool matchValue([[maybe_unused]] const HeldValue& held) noexcept(true)
+        { return false; }
+
+        /**
+         * @brief <BR>Get ready status
+         * @return [FALSE] while the value depends on an asynchronous or coroutine behaviour that hasn't completed yet
+         */
+        [[nodiscard]] virtual bool isReady() noexcept(true)
+        { return true; }
+
         /**
          * @brief <BR>Custom render function to override Pin appearance
          * @param r Function or lambda expression with new ImGui rendering
@@ -1147,6 +2212,13 @@ namespace ImFlow
          */
         void setPos(ImVec2 pos) { m_pos = pos; }
     protected:
+        /**
+         * @brief <BR>Measure the members of the generic pin
+         * @param walk Walk the bytes are added to
+         * @param size Size of the derived pin object
+         */
+        void countMemory(MemoryWalk& walk, std::size_t size) const;
+
         PinUID                      m_uid;
         std::string                 m_name;
         std::shared_ptr<PinStyle>   m_style;
@@ -1248,6 +2320,137 @@ namespace ImFlow
          */
         const T& val() noexcept(true);
 
+        /**
+         * @brief <BR>Set the function used to hash the value
+         * @details Needed to memoize outputs depending on types without a std::hash specialization. The values are still compared with operator==.
+         * @param h Hashing function. Set to nullptr to go back to std::hash
+         */
+        InPin<T>* hasher(std::size_t (*h)(const T&)) noexcept(true) { m_hasher = h; return this; }
+
+        /**
+         * @brief <BR>Hash the current value of the pin
+         * @param seed Running hash the value's hash is combined into
+         * @return [FALSE] if the type has neither a custom hasher nor a std::hash specialization
+         */
+        [[nodiscard]] bool hashValue(std::size_t& seed) noexcept(true) override;
+
+        /**
+         * @brief <BR>Copy the current value of the pin
+         * @param out Copies to append the pin's to
+         * @return [FALSE] if the type can't be copied or compared with operator==
+         */
+        [[nodiscard]] bool holdValue(HeldValues& out) noexcept(true) override;
+
+        /**
+         * @brief <BR>Compare the current value of the pin to a copy
+         * @param held Copy taken by holdValue()
+         * @return [TRUE] if the copy was taken from this pin, and is equal to its value
+         */
+        [[nodiscard]] bool matchValue(const HeldValue& held) noexcept(true) override;
+
+        /**
+         * @brief <BR>Get ready status
+         * @return [FALSE] while the connected output is waiting for an asynchronous or coroutine behaviour
+         */
+        [[nodiscard]] bool isReady() noexcept(true) override
+        { return !m_link || m_link->left()->isReady(); }
+
+        /**
+         * @brief <BR>Turn the input into an event stream
+         * @details The input then queues every item pushed by the connected output (see OutPin::push()), instead of only seeing its latest value.
+         * @param capacity Maximum number of queued items. Rounded up to a power of two. Set to 0 to go back to a plain input
+         * @param policy Behaviour when the queue is full
+         * @return Pointer to this pin
+         */
+        InPin<T>* stream(std::size_t capacity, StreamPolicy policy = StreamPolicy_DropOldest)
+        { m_stream = capacity ? make_tagged<EventQueue<T>, AllocTag_Evaluation>(capacity, policy) : nullptr; return this; }
+
+        /**
+         * @brief <BR>Get event stream status
+         * @return [TRUE] if the input queues the pushed items
+         */
+        [[nodiscard]] bool isStream() const noexcept(true)
+        { return m_stream != nullptr; }
+
+        /**
+         * @brief <BR>Queue an item. Thread-safe
+         * @details Called by OutPin::push(). Ignored if the input isn't an event stream.
+         * @param item Item to queue
+         */
+        void receive(const T& item)
+        { if (m_stream) m_stream->push(item); }
+
+        /**
+         * @brief <BR>Consume the queued items in a batch. Thread-safe
+         * @param fn Function or lambda expression called with each item, oldest first
+         * @param max Maximum number of items to consume
+         * @return Number of items consumed
+         */
+        template<class F> std::size_t drain(F&& fn, std::size_t max = SIZE_MAX)
+        { return m_stream ? m_stream->drain(std::forward<F>(fn), max) : 0; }
+
+        /**
+         * @brief <BR>Get queue depth of the event stream
+         * @return Approximate number of queued items
+         */
+        [[nodiscard]] std::size_t streamDepth() const noexcept(true)
+        { return m_stream ? m_stream->depth() : 0; }
+
+        /**
+         * @brief <BR>Get drop counter of the event stream
+         * @return Number of items discarded by the policy so far
+         */
+        [[nodiscard]] uint64_t streamDrops() const noexcept(true)
+        { return m_stream ? m_stream->drops() : 0; }
+
+        /**
+         * @brief <BR>Get the size of a value in a batch column
+         * @return Size of T. 0 if T isn't trivially copyable
+         */
+        [[nodiscard]] std::size_t columnSize() const noexcept(true) override
+        { return std::is_trivially_copyable_v<T> ? sizeof(T) : 0; }
+
+        /**
+         * @brief <BR>Measure the pin and its event stream
+         * @param walk Walk the bytes are added to
+         */
+        void memoryUsage(MemoryWalk& walk) const override;
+
+        /**
+         * @brief <BR>Get the default value as raw bytes
+         * @return Value returned while unconnected. Empty if T isn't trivially copyable
+         */
+        [[nodiscard]] std::span<const std::byte> defaultBytes() const noexcept(true) override
+        {
+            if constexpr (std::is_trivially_copyable_v<T>)
+                return { reinterpret_cast<const std::byte*>(&m_emptyVal), sizeof(T) };
+            return {};
+        }
+
+        /**
+         * @brief <BR>Set the default value from raw bytes
+         * @param bytes Bytes returned by defaultBytes()
+         * @return [FALSE] if the size doesn't match T
+         */
+        bool setDefaultBytes(std::span<const std::byte> bytes) noexcept(true) override
+        {
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                if (bytes.size() != sizeof(T))
+                    return false;
+                std::memcpy(&m_emptyVal, bytes.data(), sizeof(T));
+                return true;
+            }
+            return bytes.empty();
+        }
+
+        /**
+         * @brief <BR>Fill a batch column with the value of the input
+         * @param dst Start of the column
+         * @param count Number of values
+         */
+        void fillColumn(std::byte* dst, std::size_t count) noexcept(true) override;
+
     protected:
         /**
          * @brief <BR>Used by output pins to calculate their values
@@ -1266,9 +2469,138 @@ namespace ImFlow
         std::shared_ptr<Link> m_link;
         T m_emptyVal;
         std::function<bool(Pin*, Pin*)> m_filter;
+        std::size_t (*m_hasher)(const T&) = nullptr;
+        TaggedPtr<EventQueue<T>, AllocTag_Evaluation> m_stream;
         bool m_allowSelfConnection = false;
     };
 
+    /**
+     * @brief Bounded cache of output values, keyed by the values of the inputs
+     * @details Most recently used first. Meant for small capacities, lookups are linear.
+     *          <BR> Entries are found by the hash of the inputs, then checked against copies of their values: colliding hashes are misses.
+     * @tparam T Data type of the cached values
+     */
+    template<class T> struct MemoCache
+    {
+        /// @brief Cached value, with the inputs it was computed from
+        struct Entry
+        {
+            std::size_t key;
+            HeldValues  ins;
+            T           val;
+        };
+
+        /***/
+        explicit MemoCache(std::size_t capacity) noexcept(true)
+          : capacity(capacity > 0 ? capacity : 1)
+        { entries.reserve(this->capacity); }
+
+        /**
+         * @brief <BR>Look up a value and mark it as most recently used
+         * @param key Hash of the inputs
+         * @param match Checks the copies of the inputs of an entry with the same hash
+         * @return Pointer to the cached value, or nullptr on a miss
+         */
+        template<class Match> const T* find(std::size_t key, Match&& match) noexcept(true)
+        {
+            auto it = std::find_if(entries.begin(), entries.end(), [key, &match](const Entry& e) { return e.key == key && match(e.ins); });
+            if (it == entries.end())
+                return nullptr;
+            std::rotate(entries.begin(), it, it + 1);
+            return &entries.front().val;
+        }
+
+        /**
+         * @brief <BR>Store a value as most recently used, evicting the least recently used one if full
+         * @param key Hash of the inputs
+         * @param ins Copies of the inputs
+         * @param val Value to be cached
+         */
+        void insert(std::size_t key, HeldValues ins, const T& val) noexcept(true)
+        {
+            if (entries.size() == capacity)
+                entries.pop_back();
+            entries.emplace(entries.begin(), Entry{key, std::move(ins), val});
+        }
+
+        std::size_t capacity;
+        std::vector<Entry, TaggedAllocator<Entry, AllocTag_Evaluation>> entries;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    /**
+     * @brief Asynchronous output status
+     */
+    enum AsyncStatus
+    {
+        AsyncStatus_Idle,
+        AsyncStatus_Pending,
+        AsyncStatus_Ready
+    };
+
+    /**
+     * @brief Job run on the background executor by an asynchronous output
+     * @details Must only use data it owns, and should return early once stop is requested.
+     */
+    template<class T> using AsyncJob = std::function<T(std::stop_token)>;
+
+    /**
+     * @brief Bookkeeping of an asynchronous output
+     * @tparam T Data type produced by the jobs
+     */
+    template<class T> struct AsyncState
+    {
+        /**
+         * @brief Shared between the pin and the worker running the job
+         */
+        struct Job
+        {
+            std::stop_source  stop;
+            std::optional<T>  result;
+            std::atomic<bool> done = false;
+        };
+
+        /***/
+        ~AsyncState() { if (job) job->stop.request_stop(); }
+
+        std::function<AsyncJob<T>()> launcher;
+        std::shared_ptr<Job>         job;
+        std::function<Task<T>()>     taskLauncher;
+        std::optional<Task<T>>       task;
+        std::size_t                  key = 0;
+        HeldValues                   ins;
+        bool                         held = false;
+        bool                         launched = false;
+        bool                         dirty = false;
+        bool                         completed = false;
+    };
+
+    /**
+     * @brief Suspends a node coroutine until an input is ready
+     * @tparam T Data type of the input
+     */
+    template<class T> struct InputReadyAwaiter : TaskWaiter
+    {
+        explicit InputReadyAwaiter(InPin<T>* pin) noexcept(true) : pin(pin) {}
+
+        // Reading the value is what launches the pending work upstream
+        bool ready() noexcept(true) override { pin->val(); return pin->isReady(); }
+        bool await_ready() noexcept(true) { return ready(); }
+        template<class P> void await_suspend(std::coroutine_handle<P> h) noexcept(true) { park(h); }
+        T await_resume() noexcept(true) { return pin->val(); }
+
+        InPin<T>* pin;
+    };
+
+    /**
+     * @brief <BR>Suspend a node coroutine until an input is ready, and get its value
+     * @tparam T Data type of the input
+     * @param pin Generic pointer to the input pin (see BaseNode::inPin())
+     */
+    template<class T> InputReadyAwaiter<T> inputReady(Pin* pin) noexcept(true)
+    { return InputReadyAwaiter<T>(static_cast<InPin<T>*>(pin)); }
+
     /**
      * @brief Output specific pin
      * @details Derived from the generic class Pin. The output pin handles the logic.
@@ -1293,7 +2625,7 @@ namespace ImFlow
          * @brief <BR>When parent gets deleted, remove the links
          */
         ~OutPin() override {
-            std::vector<std::weak_ptr<Link>> links = std::move(m_links);
+            auto links = std::move(m_links);
             for (auto &l: links) if (!l.expired()) l.lock()->right()->deleteLink();
         }
 
@@ -1330,6 +2662,8 @@ namespace ImFlow
 
         /**
          * @brief <BR>Get output value
+         * @details During update() while the evaluator runs, the value of the published pass.
+         *          Outputs of types that can't be copied aren't published: don't read them from update() meanwhile.
          * @return Const reference to the internal value of the pin
          */
         const T& val() noexcept(true);
@@ -1341,6 +2675,177 @@ namespace ImFlow
          */
         OutPin<T>* behaviour(std::function<T()> func) { m_behaviour = std::move(func); return this; }
 
+        /**
+         * @brief <BR>Set logic to calculate output value, once the evaluator doesn't run it
+         * @details Taken in the structural phase at the end of ImNodeFlow::update().
+         * @param func Function or lambda expression used to calculate output value
+         */
+        void stageBehaviour(std::function<T()> func) noexcept(true) { m_stagedBehaviour = std::move(func); }
+
+        /**
+         * @brief <BR>Set asynchronous logic to calculate output value
+         * @details Replaces behaviour(). The launcher runs whenever the values of the parent node's inputs change, dynamic ones included:
+         *          it must read what it needs and return a job working only on those copies.
+         *          <BR> It runs on the thread evaluating the graph: the UI thread in update(), the evaluator thread while
+         *          ImNodeFlow::startEvaluator() runs. Don't touch state the UI changes without synchronization from it.
+         *          The job then runs on the handler's executor, and the previous one is asked to stop.
+         *          <BR> Until the job completes val() keeps returning the last completed value, so it never blocks.
+         *          <BR> If an input can't be hashed the job is only launched again after invalidate().
+         * @param launcher Function or lambda expression returning the job for the current inputs
+         */
+        OutPin<T>* asyncBehaviour(std::function<AsyncJob<T>()> launcher)
+        { m_async = make_tagged<AsyncState<T>, AllocTag_Evaluation>(); m_async->launcher = std::move(launcher); return this; }
+
+        /**
+         * @brief <BR>Set coroutine logic to calculate output value
+         * @details Replaces behaviour(). A new coroutine is started whenever the values of the parent node's inputs change, dynamic
+         *          ones included, replacing the previous one if still suspended. It starts on the thread evaluating the graph (the
+         *          evaluator thread while ImNodeFlow::startEvaluator() runs), then is resumed by the handler's scheduler in update().
+         *          <BR> Until the coroutine returns val() keeps returning the last returned value.
+         *          <BR> If an input can't be hashed the coroutine is only started again after invalidate().
+         * @param launcher Function or lambda expression starting the coroutine
+         */
+        OutPin<T>* taskBehaviour(std::function<Task<T>()> launcher)
+        { m_async = make_tagged<AsyncState<T>, AllocTag_Evaluation>(); m_async->taskLauncher = std::move(launcher); return this; }
+
+        /**
+         * @brief <BR>Get asynchronous status
+         * @return Pending while a job or coroutine is running, Ready once a value is available, Idle before that
+         */
+        [[nodiscard]] AsyncStatus asyncStatus() const noexcept(true)
+        {
+            if (!m_async) return AsyncStatus_Ready;
+            if (m_async->job || m_async->task) return AsyncStatus_Pending;
+            return m_async->completed ? AsyncStatus_Ready : AsyncStatus_Idle;
+        }
+
+        /**
+         * @brief <BR>Get ready status
+         * @return [TRUE] once a value is available
+         */
+        [[nodiscard]] bool isReady() noexcept(true) override
+        { return asyncStatus() == AsyncStatus_Ready; }
+
+        /**
+         * @brief <BR>Force the asynchronous job to be launched again on the next evaluation
+         */
+        void invalidate() noexcept(true)
+        { if (m_async) m_async->dirty = true; }
+
+        /**
+         * @brief <BR>Get behaviour cost
+         * @details Self time of the behaviour, while the profiler records.
+         * @return Reference to the stats
+         */
+        constexpr ProfileStats& getStats() noexcept(true)
+        { return m_stats; }
+
+        /**
+         * @brief <BR>Clear the profiler stats of the pin
+         */
+        void resetStats() noexcept(true) override
+        { m_stats.reset(); }
+
+        /**
+         * @brief <BR>Push an event to the connected inputs
+         * @details Queued by each input turned into an event stream with the same data type, the others ignore it.
+         *          <BR> Lock-free, but reads the links: from another thread, hold ImNodeFlow::lockGraph().
+         * @param item Item to push
+         */
+        void push(const T& item);
+
+        /**
+         * @brief <BR>Memoize the behaviour
+         * @details Results are cached by the values of the parent node's inputs, static and dynamic.
+         *          When the inputs go back to a combination seen recently the cached result is returned without running the behaviour.
+         *          Each result keeps copies of the inputs, compared on a hit: inputs whose values can't be hashed, copied
+         *          or compared with operator== make the behaviour run every time.
+         *          <BR> Only for pure behaviours: anything else the behaviour reads is not part of the key.
+         *          <BR> Ignored for types that can't be copied.
+         * @param capacity Maximum number of cached results. Set to 0 to disable
+         */
+        OutPin<T>* memoize(std::size_t capacity) { m_memo = capacity ? make_tagged<MemoCache<T>, AllocTag_Evaluation>(capacity) : nullptr; return this; }
+
+        /**
+         * @brief <BR>Get memoization hits
+         * @return Number of times a cached result was returned
+         */
+        [[nodiscard]] uint64_t memoHits() const noexcept(true)
+        { return m_memo ? m_memo->hits : 0; }
+
+        /**
+         * @brief <BR>Get memoization misses
+         * @return Number of times the behaviour had to run
+         */
+        [[nodiscard]] uint64_t memoMisses() const noexcept(true)
+        { return m_memo ? m_memo->misses : 0; }
+
+        /**
+         * @brief <BR>Turn the pin into a delay output
+         * @details From now on val() returns the value committed at the end of the previous evaluation pass.
+         * @param initial Value returned until the first pass is committed
+         */
+        OutPin<T>* delay(T initial) { m_val = std::move(initial); m_next = make_tagged<T, AllocTag_Evaluation>(m_val); return this; }
+
+        /**
+         * @brief <BR>Get delay status
+         * @return [TRUE] if the pin outputs the value of the previous evaluation pass
+         */
+        [[nodiscard]] bool isDelay() const noexcept(true) override
+        { return m_next != nullptr; }
+
+        /**
+         * @brief <BR>Calculate the value of the current evaluation pass
+         * @details Delay outputs store it aside until commit(), other outputs behave like val().
+         */
+        void resolve() noexcept(true) override;
+
+        /**
+         * @brief <BR>Publish the value calculated by resolve()
+         */
+        void commit() noexcept(true) override;
+
+        /**
+         * @brief <BR>Store the current value in a snapshot slot
+         * @param slot Index of the slot
+         */
+        void publish(uint8_t slot) noexcept(true) override;
+
+        /**
+         * @brief <BR>Allocate the snapshot and fill every slot with the current value
+         * @details Nothing is allocated for types that can't be copied.
+         */
+        void seedSnapshot() override;
+
+        /**
+         * @brief <BR>Take the staged behaviour, if any
+         */
+        void swapBehaviour() noexcept(true) override
+        {
+            if (m_stagedBehaviour)
+                m_behaviour = std::exchange(m_stagedBehaviour, nullptr);
+        }
+
+        /**
+         * @brief <BR>Get the size of a value in a batch column
+         * @return Size of T. 0 if T isn't trivially copyable
+         */
+        [[nodiscard]] std::size_t columnSize() const noexcept(true) override
+        { return std::is_trivially_copyable_v<T> ? sizeof(T) : 0; }
+
+        /**
+         * @brief <BR>Measure the pin and its evaluation state
+         * @param walk Walk the bytes are added to
+         */
+        void memoryUsage(MemoryWalk& walk) const override;
+
+        /**
+         * @brief <BR>Fill a batch column with the last value of the output
+         * @param dst Start of the column
+         * @param count Number of values
+         */
+        void fillColumn(std::byte* dst, std::size_t count) noexcept(true) override;
+
         /**
          * @brief <BR>Get pin's data type (aka: \<T>)
          * @return String containing unique information identifying the data type
@@ -1348,17 +2853,34 @@ namespace ImFlow
         [[nodiscard]] const std::type_info& getDataType() const noexcept(true) override 
         { return typeid(T); };
 
-    protected:
+    private:
         /**
-         * @brief <BR>Used by output pins to calculate their values
+         * @brief <BR>Run the behaviour, or fetch its result from the memoization cache
+         * @return Value for the current evaluation pass
          */
-        virtual void resolve() noexcept(true) override
-        {}
+        T compute() noexcept(true);
 
-    private:
-        std::vector<std::weak_ptr<Link>> m_links;
-        std::function<T()>               m_behaviour;
-        T                                m_val;
+        /**
+         * @brief <BR>Run the behaviour, timing it if the profiler records
+         * @return Value returned by the behaviour
+         */
+        T run() noexcept(true);
+
+        /**
+         * @brief <BR>Collect the completed job, and launch a new one if the inputs changed
+         */
+        void pollAsync() noexcept(true);
+
+        std::vector<std::weak_ptr<Link>, TaggedAllocator<std::weak_ptr<Link>, AllocTag_Links>> m_links;
+        std::function<T()>                               m_behaviour;
+        std::function<T()>                               m_stagedBehaviour;
+        T                                                m_val{};
+        uint64_t                                         m_evalFrame = 0;
+        TaggedPtr<T, AllocTag_Evaluation>                m_next;
+        TaggedPtr<MemoCache<T>, AllocTag_Evaluation>     m_memo;
+        TaggedPtr<AsyncState<T>, AllocTag_Evaluation>    m_async;
+        TaggedPtr<std::array<T, 3>, AllocTag_Evaluation> m_snapshot;
+        ProfileStats                                     m_stats;
     };
 }
 
@@ -1,4 +1,10 @@
 #include "ImNodeFlow.h"
+#include "block_plan.h"
+#include "graph_binary.h"
+#include "node_registry.h"
+#include "parameter_sweep.h"
+#include <latch>
+#include <fstream>
 
 namespace ImFlow {
     // -----------------------------------------------------------------------------------------------------------------
@@ -28,13 +34,18 @@ namespace ImFlow {
                          thickness + m_left->getStyle()->extra.link_selected_outline_thickness);
         smart_bezier(start, end, m_left->getStyle()->color, thickness);
 
-        if (m_selected && ImGui::IsKeyPressed(ImGuiKey_Delete, false))
-            m_right->deleteLink();
+        if (m_selected && ImGui::IsKeyPressed(ImGuiKey_Delete, false)) {
+            if (m_inf->readsSnapshot())
+                m_inf->postLinkEdit(m_left, m_right, false);
+            else
+                m_right->deleteLink();
+        }
     }
 
     Link::~Link() noexcept(true)
     {
         m_left->deleteLink();
+        m_inf->removeLink(this);
     }
 
     // -----------------------------------------------------------------------------------------------------------------
@@ -65,15 +76,13 @@ namespace ImFlow {
         // Header
         ImGui::BeginGroup();
         if ( m_style->header_title_font != nullptr ) {
-          ImGui::PushFont(m_style->header_title_font);
-          ImGui::PushFontSize(m_style->header_title_font_size);
+          ImGui::PushFont(m_style->header_title_font, m_style->header_title_font_size);
         }
         
         ImGui::TextColored(m_style->header_title_color, "%s", m_title.c_str());
         ImGui::Spacing();
         
         if ( m_style->header_title_font != nullptr ) {
-          ImGui::PopFontSize();
           ImGui::PopFont();
         }
         ImGui::EndGroup();
@@ -101,7 +110,13 @@ namespace ImFlow {
 
         // Content
         ImGui::BeginGroup();
-        draw();
+        if (m_inf->isProfiling()) {
+            ProfileScope scope(m_inf->profileChildren());
+            draw();
+            m_drawStats.add(scope.stop());
+        }
+        else
+            draw();
         ImGui::Dummy(ImVec2(0.f, 0.f));
         ImGui::EndGroup();
         ImGui::SameLine();
@@ -153,7 +168,10 @@ namespace ImFlow {
         draw_list->ChannelsSetCurrent(0);
         draw_list->AddRectFilled(offset + m_pos - paddingTL, offset + m_pos + m_size + paddingBR, m_style->bg,
                                  m_style->radius);
-        draw_list->AddRectFilled(offset + m_pos - paddingTL, offset + m_pos + headerSize, m_style->header_bg,
+        ImU32 headerBg = m_style->header_bg;
+        if (m_inf->isProfileOverlay() && m_inf->getProfileMax() > 0)
+            headerBg = heat_tint(headerBg, static_cast<float>(getShownEvalStats().ns + m_drawStats.ns) / static_cast<float>(m_inf->getProfileMax()));
+        draw_list->AddRectFilled(offset + m_pos - paddingTL, offset + m_pos + headerSize, headerBg,
                                  m_style->radius, ImDrawFlags_RoundCornersTop);
 
         ImU32 col = m_style->border_color;
@@ -196,6 +214,10 @@ namespace ImFlow {
             m_inf->draggingNode(true);
         }
         if (m_dragged || (m_selected && m_inf->isNodeDragged())) {
+            if (!m_moving) {
+                m_moving = true;
+                m_moveStart = m_pos;
+            }
             float step = m_inf->getStyle().grid_size / m_inf->getStyle().grid_subdivisions;
             m_posTarget += ImGui::GetIO().MouseDelta;
             // "Slam" The position
@@ -206,17 +228,70 @@ namespace ImFlow {
                 m_dragged = false;
                 m_inf->draggingNode(false);
                 m_posTarget = m_pos;
+                m_moving = false;
+                if (m_pos.x != m_moveStart.x || m_pos.y != m_moveStart.y)
+                    m_inf->nodeMoved(this, m_moveStart);
             }
         }
         ImGui::PopID();
+    }
 
+    void BaseNode::sweepPins()
+    {
         // Deleting dead pins
         m_dynamicIns.erase(std::remove_if(m_dynamicIns.begin(), m_dynamicIns.end(),
                                           [](const std::pair<int, std::shared_ptr<Pin>> &p) { return p.first == 0; }),
                            m_dynamicIns.end());
         m_dynamicOuts.erase(std::remove_if(m_dynamicOuts.begin(), m_dynamicOuts.end(),
-                                           [](const std::pair<int, std::shared_ptr<Pin>> &p) { return p.first == 0; }),
+                                           [](const std::pair<int, std::shared_ptr<Pin>> &p) { return p.first <= 0; }),
                             m_dynamicOuts.end());
+
+        // Adding the pins shown while the evaluator ran
+        for (auto &p: m_dynamicOuts) { p.second->swapBehaviour(); }
+        for (auto &p: m_stagedPins) {
+            if (p.second->getType() == PinType_Input) {
+                m_dynamicIns.push_back(std::move(p));
+            } else {
+                if (m_inf->isEvaluatorRunning())
+                    p.second->seedSnapshot();
+                m_dynamicOuts.push_back(std::move(p));
+            }
+        }
+        m_stagedPins.clear();
+    }
+
+    void BaseNode::memoryUsage(MemoryWalk& walk) const
+    {
+        MemoryStats& s = walk.stats;
+        s.nodeCount++;
+        s.nodes += m_footprint + shared_block_bytes() - sizeof(m_title) - sizeof(m_blockProcess) - sizeof(m_batchProcess);
+        s.strings += sizeof(m_title) + string_heap_bytes(m_title);
+        s.functions += sizeof(m_blockProcess) + sizeof(m_batchProcess);
+        if (walk.first(m_style.get()))
+            s.styles += sizeof(NodeStyle) + shared_block_bytes();
+
+        s.graph += vector_bytes(m_upstream) + vector_bytes(m_upstreamLinks) + vector_bytes(m_downstream) + vector_bytes(m_downstreamLinks);
+        s.graph += vector_bytes(m_ins) + vector_bytes(m_dynamicIns) + vector_bytes(m_outs) + vector_bytes(m_dynamicOuts) + vector_bytes(m_stagedPins);
+
+        for (auto &p: m_ins) { p->memoryUsage(walk); }
+        for (auto &p: m_dynamicIns) { p.second->memoryUsage(walk); }
+        for (auto &p: m_outs) { p->memoryUsage(walk); }
+        for (auto &p: m_dynamicOuts) { p.second->memoryUsage(walk); }
+        for (auto &p: m_stagedPins) { p.second->memoryUsage(walk); }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // PIN
+
+    void Pin::countMemory(MemoryWalk& walk, std::size_t size) const
+    {
+        MemoryStats& s = walk.stats;
+        s.pinCount++;
+        s.pins += size + shared_block_bytes() - sizeof(m_name) - sizeof(m_renderer);
+        s.strings += sizeof(m_name) + string_heap_bytes(m_name);
+        s.functions += sizeof(m_renderer);
+        if (walk.first(m_style.get()))
+            s.styles += sizeof(PinStyle) + shared_block_bytes();
     }
 
     // -----------------------------------------------------------------------------------------------------------------
@@ -252,23 +327,1161 @@ namespace ImFlow {
         return ( p + m_context.scroll() ) * m_context.scale() + m_context.origin();
     }
 
+    ImNodeFlow::~ImNodeFlow()
+    {
+        m_observers.clear();
+        stopEvaluator();
+        m_commands.clear();
+        tagged_delete<AllocTag_Evaluation>(m_blockActive);
+        tagged_delete<AllocTag_Evaluation>(m_blockPending.exchange(nullptr));
+        tagged_delete<AllocTag_Evaluation>(m_blockRetired.exchange(nullptr));
+        m_nodes.clear();
+    }
+
     void ImNodeFlow::addLink(std::shared_ptr<Link> &link) noexcept(true)
-    {  m_links.push_back(link); }
+    {
+        m_links.push_back(link);
+        if (link->isCyclic())
+            m_cyclicLinks.push_back(link.get());
+        graphChanged();
+
+        BaseNode* left = link->left()->getParent();
+        BaseNode* right = link->right()->getParent();
+        left->m_downstream.push_back(right);
+        left->m_downstreamLinks.push_back(link.get());
+        right->m_upstream.push_back(left);
+        right->m_upstreamLinks.push_back(link.get());
+        for (auto* o: m_observers) o->linkAdded(*link);
+    }
+
+    void ImNodeFlow::removeLink(Link* link) noexcept(true)
+    {
+        for (auto* o: m_observers) o->linkRemoved(*link);
+
+        // Swap-and-pop keeps the two parallel lists aligned without shifting them
+        auto unlink = [link](auto& nodes, auto& links)
+        {
+            auto it = std::find(links.begin(), links.end(), link);
+            if (it == links.end())
+                return;
+            auto i = std::distance(links.begin(), it);
+            nodes[i] = nodes.back();
+            nodes.pop_back();
+            links[i] = links.back();
+            links.pop_back();
+        };
+
+        BaseNode* left = link->left()->getParent();
+        BaseNode* right = link->right()->getParent();
+        unlink(left->m_downstream, left->m_downstreamLinks);
+        unlink(right->m_upstream, right->m_upstreamLinks);
+        if (link->isCyclic()) {
+            auto it = std::find(m_cyclicLinks.begin(), m_cyclicLinks.end(), link);
+            if (it != m_cyclicLinks.end()) {
+                *it = m_cyclicLinks.back();
+                m_cyclicLinks.pop_back();
+            }
+        }
+        graphChanged();
+
+        // The removed dependency may have been the path closing other links' cycles: they join the order if they fit in it now
+        if (!link->isDependency())
+            return;
+        for (size_t i = 0; i < m_cyclicLinks.size();)
+        {
+            Link* other = m_cyclicLinks[i];
+            if (other->m_left->getParent() != other->m_right->getParent() && orderLink(other->m_left, other->m_right)) {
+                other->m_cyclic = false;
+                m_cyclicLinks[i] = m_cyclicLinks.back();
+                m_cyclicLinks.pop_back();
+            }
+            else
+                i++;
+        }
+    }
+
+    bool ImNodeFlow::orderLink(Pin* left, Pin* right) noexcept(true)
+    {
+        BaseNode* from = left->getParent();
+        BaseNode* to = right->getParent();
+        if (from == to)
+            return false;
+        if (from->m_topoIndex < to->m_topoIndex)
+            return true;
+
+        const uint32_t lower = to->m_topoIndex;
+        const uint32_t upper = from->m_topoIndex;
+
+        // Forward search from "to", bounded by the index of "from": reaching it means the link closes a cycle
+        m_orderForward.clear();
+        m_orderStack.clear();
+        m_visitEpoch++;
+        to->m_visitMark = m_visitEpoch;
+        m_orderStack.push_back(to);
+        while (!m_orderStack.empty())
+        {
+            BaseNode* n = m_orderStack.back();
+            m_orderStack.pop_back();
+            m_orderForward.push_back(n);
+            for (size_t i = 0; i < n->m_downstream.size(); i++)
+            {
+                BaseNode* d = n->m_downstream[i];
+                if (!n->m_downstreamLinks[i]->isDependency())
+                    continue;
+                if (d == from)
+                    return false;
+                if (d->m_visitMark != m_visitEpoch && d->m_topoIndex < upper)
+                {
+                    d->m_visitMark = m_visitEpoch;
+                    m_orderStack.push_back(d);
+                }
+            }
+        }
+
+        // Backward search from "from", bounded by the index of "to"
+        m_orderBackward.clear();
+        m_visitEpoch++;
+        from->m_visitMark = m_visitEpoch;
+        m_orderStack.push_back(from);
+        while (!m_orderStack.empty())
+        {
+            BaseNode* n = m_orderStack.back();
+            m_orderStack.pop_back();
+            m_orderBackward.push_back(n);
+            for (size_t i = 0; i < n->m_upstream.size(); i++)
+            {
+                BaseNode* u = n->m_upstream[i];
+                if (!n->m_upstreamLinks[i]->isDependency())
+                    continue;
+                if (u->m_visitMark != m_visitEpoch && u->m_topoIndex > lower)
+                {
+                    u->m_visitMark = m_visitEpoch;
+                    m_orderStack.push_back(u);
+                }
+            }
+        }
+
+        // Reassign the indexes of the affected region: everything that reaches "from" goes before everything reached by "to"
+        auto byIndex = [](const BaseNode* a, const BaseNode* b) { return a->m_topoIndex < b->m_topoIndex; };
+        std::sort(m_orderBackward.begin(), m_orderBackward.end(), byIndex);
+        std::sort(m_orderForward.begin(), m_orderForward.end(), byIndex);
+        m_orderPool.clear();
+        for (BaseNode* n : m_orderBackward)
+            m_orderPool.push_back(n->m_topoIndex);
+        for (BaseNode* n : m_orderForward)
+            m_orderPool.push_back(n->m_topoIndex);
+        std::sort(m_orderPool.begin(), m_orderPool.end());
+
+        size_t i = 0;
+        for (BaseNode* n : m_orderBackward)
+            n->m_topoIndex = m_orderPool[i++];
+        for (BaseNode* n : m_orderForward)
+            n->m_topoIndex = m_orderPool[i++];
+        return true;
+    }
+
+    void ImNodeFlow::addDelay(const std::shared_ptr<Pin>& pin) noexcept(true)
+    { m_delays.push_back(pin); }
+
+    void ImNodeFlow::finishEvaluation() noexcept(true)
+    {
+        // Two phases: no delay can observe another one's new value
+        m_delays.erase(std::remove_if(m_delays.begin(), m_delays.end(),
+                                      [](const std::weak_ptr<Pin> &p) { return p.expired(); }), m_delays.end());
+        for (auto &p: m_delays) {
+            auto pin = p.lock();
+            if (pin->getParent()->isLive())
+                pin->resolve();
+        }
+        for (auto &p: m_delays) { p.lock()->commit(); }
+
+        m_evalFrame++;
+    }
+
+    std::span<BaseNode* const> ImNodeFlow::getEvaluationPlan() noexcept(true)
+    {
+        if (!m_planDirty)
+            return m_plan;
+        m_planDirty = false;
+        m_planEpoch++;
+        m_plan.clear();
+
+        // Upstream closure of the sinks. Every link counts: delays still resolve their inputs at the end of the pass
+        m_orderStack.clear();
+        m_visitEpoch++;
+        for (auto &n: m_nodes) {
+            if (n.second->isSink()) {
+                n.second->m_visitMark = m_visitEpoch;
+                m_orderStack.push_back(n.second.get());
+            }
+        }
+        while (!m_orderStack.empty()) {
+            BaseNode* n = m_orderStack.back();
+            m_orderStack.pop_back();
+            n->m_planMark = m_planEpoch;
+            m_plan.push_back(n);
+            for (BaseNode* u : n->m_upstream) {
+                if (u->m_visitMark != m_visitEpoch) {
+                    u->m_visitMark = m_visitEpoch;
+                    m_orderStack.push_back(u);
+                }
+            }
+        }
+
+        std::sort(m_plan.begin(), m_plan.end(),
+                  [](const BaseNode* a, const BaseNode* b) { return a->m_topoIndex < b->m_topoIndex; });
+        return m_plan;
+    }
+
+    ThreadPool& ImNodeFlow::getExecutor() noexcept(true)
+    {
+        if (!m_executor)
+            m_executor = make_tagged<ThreadPool, AllocTag_Evaluation>();
+        return *m_executor;
+    }
+
+    void ImNodeFlow::evaluate() noexcept(true)
+    {
+        for (BaseNode* n : getEvaluationPlan()) {
+            for (auto &p: n->m_outs) { p->resolve(); }
+            for (auto &p: n->m_dynamicOuts) { p.second->resolve(); }
+        }
+    }
+
+    void ImNodeFlow::startEvaluator(std::chrono::microseconds period, std::chrono::microseconds wait)
+    {
+        stopEvaluator();
+        m_graphWait = wait;
+        {
+            // Seed the whole snapshot: update() reads it from now on
+            auto lock = lockGraph();
+            for (auto &n: m_nodes) { seed(n.second.get()); }
+        }
+        m_evaluator = std::jthread([this, period](std::stop_token stop) { evaluatorLoop(stop, period); });
+    }
+
+    void ImNodeFlow::stopEvaluator()
+    {
+        if (!m_evaluator.joinable())
+            return;
+        m_evaluator.request_stop();
+        m_evaluator.join();
+    }
+
+    std::unique_lock<std::mutex> ImNodeFlow::lockGraph()
+    {
+        // Announced first: the evaluator only checks it between two nodes, and then lets the waiter in before locking again
+        m_graphWaiters.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock lock(m_graphMutex);
+        m_graphWaiters.fetch_sub(1, std::memory_order_release);
+        return lock;
+    }
+
+    std::unique_lock<std::mutex> ImNodeFlow::tryLockGraph(std::chrono::microseconds wait)
+    {
+        auto deadline = std::chrono::steady_clock::now() + wait;
+        m_graphWaiters.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock lock(m_graphMutex, std::try_to_lock);
+        while (!lock.owns_lock() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+            (void)lock.try_lock();
+        }
+        // Withdrawn either way: a node slower than the wait finishes its pass undisturbed
+        m_graphWaiters.fetch_sub(1, std::memory_order_release);
+        return lock;
+    }
+
+    void ImNodeFlow::postLinkEdit(Pin* from, Pin* to, bool create)
+    {
+        auto hold = [this](Pin* p) -> std::pair<std::weak_ptr<BaseNode>, std::weak_ptr<Pin>>
+        {
+            BaseNode* n = p->getParent();
+            auto node = m_nodes.find(n->getUID());
+            if (node == m_nodes.end())
+                return {};
+            for (auto& q : n->m_ins) { if (q.get() == p) return {node->second, q}; }
+            for (auto& q : n->m_outs) { if (q.get() == p) return {node->second, q}; }
+            for (auto& q : n->m_dynamicIns) { if (q.second.get() == p) return {node->second, q.second}; }
+            for (auto& q : n->m_dynamicOuts) { if (q.second.get() == p) return {node->second, q.second}; }
+            return {};
+        };
+        m_linkEdits.push_back({hold(from), hold(to), create});
+    }
+
+    void ImNodeFlow::applyLinkEdits()
+    {
+        auto alive = [this](const std::pair<std::weak_ptr<BaseNode>, std::weak_ptr<Pin>>& h)
+        {
+            auto node = h.first.lock();
+            auto it = node ? m_nodes.find(node->getUID()) : m_nodes.end();
+            return it != m_nodes.end() && it->second == node ? h.second.lock() : nullptr;
+        };
+        for (auto &e: m_linkEdits) {
+            std::shared_ptr<Pin> a = alive(e.from), b = alive(e.to);
+            if (!a || !b)
+                continue;
+            if (e.create)
+                a->createLink(b.get());
+            else if (auto link = b->getLink().lock(); link && link->left() == a.get())
+                b->deleteLink();
+        }
+        m_linkEdits.clear();
+    }
+
+    std::future<std::weak_ptr<Link>> ImNodeFlow::postLink(std::weak_ptr<BaseNode> left, std::string outUid,
+                                                          std::weak_ptr<BaseNode> right, std::string inUid)
+    {
+        return post([left = std::move(left), outUid = std::move(outUid), right = std::move(right), inUid = std::move(inUid)]
+                    (ImNodeFlow&) -> std::weak_ptr<Link>
+        {
+            auto find = [](const PinList& pins, const std::string& uid) -> Pin*
+            {
+                PinUID h = std::hash<std::string>{}(uid);
+                auto it = std::find_if(pins.begin(), pins.end(), [h](const std::shared_ptr<Pin>& p) { return p->getUid() == h; });
+                return it != pins.end() ? it->get() : nullptr;
+            };
+
+            auto l = left.lock();
+            auto r = right.lock();
+            if (!l || !r)
+                return {};
+            Pin* out = find(l->getOuts(), outUid);
+            Pin* in = find(r->getIns(), inUid);
+            if (!out || !in)
+                return {};
+            in->createLink(out);
+            return in->getLink();
+        });
+    }
+
+    std::future<void> ImNodeFlow::postDestroy(std::weak_ptr<BaseNode> node)
+    {
+        return post([node = std::move(node)](ImNodeFlow&)
+        {
+            if (auto n = node.lock())
+                n->destroy();
+        });
+    }
+
+    void ImNodeFlow::setBlockSize(std::size_t size) noexcept(true)
+    {
+        m_blockSize = size;
+        invalidateBlockPlan();
+    }
+
+    BlockPlan* ImNodeFlow::compileBlockPlan()
+    {
+        auto* plan = tagged_new<BlockPlan, AllocTag_Evaluation>();
+        plan->blockSize = m_blockSize;
+        if (m_blockSize == 0)
+            return plan;
+
+        for (auto &n: m_nodes) {
+            if (n.second->isBlockProcessor())
+                plan->steps.push_back({n.second, n.second->m_blockProcess, {}});
+        }
+        std::sort(plan->steps.begin(), plan->steps.end(),
+                  [](const BlockPlan::Step& a, const BlockPlan::Step& b) { return a.node->m_topoIndex < b.node->m_topoIndex; });
+
+        // One buffer per output, shared by all its links. Inputs without a block processor upstream get a constant buffer
+        auto isSample = [](const std::shared_ptr<Pin>& p) { return p->getDataType() == typeid(Sample); };
+        std::unordered_map<Pin*, std::size_t, std::hash<Pin*>, std::equal_to<Pin*>,
+                           TaggedAllocator<std::pair<Pin* const, std::size_t>, AllocTag_Evaluation>> outBuffer;
+        std::size_t buffers = 0, insCount = 0;
+        for (auto &s: plan->steps) {
+            for (auto &p: s.node->m_outs) {
+                if (isSample(p))
+                    outBuffer[p.get()] = buffers++;
+            }
+            insCount += std::count_if(s.node->m_ins.begin(), s.node->m_ins.end(), isSample);
+        }
+        auto source = [&outBuffer](const std::shared_ptr<Pin>& in) -> Pin*
+        {
+            auto link = in->getLink().lock();
+            if (!link || outBuffer.find(link->left()) == outBuffer.end())
+                return nullptr;
+            return link->left();
+        };
+        std::size_t constants = 0;
+        for (auto &s: plan->steps) {
+            for (auto &p: s.node->m_ins) {
+                if (isSample(p) && !source(p))
+                    constants++;
+            }
+        }
+
+        // Sized once: the spans below point into these
+        plan->pool.assign((buffers + constants) * m_blockSize, Sample{});
+        plan->outs.reserve(buffers);
+        plan->ins.reserve(insCount);
+        auto buffer = [&](std::size_t i) { return std::span<Sample>(plan->pool.data() + i * m_blockSize, m_blockSize); };
+
+        std::size_t nextConstant = buffers;
+        for (auto &s: plan->steps) {
+            std::size_t firstOut = plan->outs.size(), firstIn = plan->ins.size();
+            for (auto &p: s.node->m_outs) {
+                if (isSample(p))
+                    plan->outs.push_back(buffer(outBuffer[p.get()]));
+            }
+            for (auto &p: s.node->m_ins) {
+                if (!isSample(p))
+                    continue;
+                if (Pin* left = source(p)) {
+                    plan->ins.emplace_back(buffer(outBuffer[left]));
+                    continue;
+                }
+                auto b = buffer(nextConstant++);
+                std::fill(b.begin(), b.end(), static_cast<InPin<Sample>*>(p.get())->val());
+                plan->ins.emplace_back(b);
+            }
+            s.io.m_outs = std::span<const std::span<Sample>>(plan->outs.data() + firstOut, plan->outs.size() - firstOut);
+            s.io.m_ins = std::span<const std::span<const Sample>>(plan->ins.data() + firstIn, plan->ins.size() - firstIn);
+            s.io.m_size = m_blockSize;
+        }
+        return plan;
+    }
+
+    void ImNodeFlow::processBlock() noexcept(true)
+    {
+        // Adopt a new plan only once the previous one has been collected: nothing is ever freed here
+        if (!m_blockRetired.load(std::memory_order_acquire)) {
+            if (BlockPlan* plan = m_blockPending.exchange(nullptr, std::memory_order_acq_rel)) {
+                m_blockRetired.store(m_blockActive, std::memory_order_release);
+                m_blockActive = plan;
+            }
+        }
+        if (!m_blockActive)
+            return;
+        for (auto &s: m_blockActive->steps) { s.process(s.io); }
+    }
+
+    void ImNodeFlow::resetProfile() noexcept(true)
+    {
+        m_profileMax = 0;
+        for (auto &n: m_nodes) {
+            n.second->m_evalStats.reset();
+            n.second->m_drawStats.reset();
+            for (auto &p: n.second->m_outs) { p->resetStats(); }
+            for (auto &p: n.second->m_dynamicOuts) { p.second->resetStats(); }
+        }
+    }
+
+    std::vector<NodeProfile> ImNodeFlow::topNodes(std::size_t n)
+    {
+        std::vector<NodeProfile> all;
+        all.reserve(m_nodes.size());
+        for (auto &node: m_nodes) { all.push_back({node.second.get(), node.second->getShownEvalStats(), node.second->m_drawStats}); }
+        n = std::min(n, all.size());
+        std::partial_sort(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(n), all.end(),
+                          [](const NodeProfile& a, const NodeProfile& b) { return a.total() > b.total(); });
+        all.resize(n);
+        return all;
+    }
+
+    void ImNodeFlow::dumpProfile(std::ostream& out, std::size_t n)
+    {
+        out << "node\teval_ms\teval_calls\tdraw_ms\tdraw_calls\n";
+        for (auto &p: topNodes(n)) {
+            out << p.node->getName() << '\t'
+                << static_cast<double>(p.eval.ns) / 1e6 << '\t' << p.eval.calls << '\t'
+                << static_cast<double>(p.draw.ns) / 1e6 << '\t' << p.draw.calls << '\n';
+        }
+    }
+
+    MemoryStats ImNodeFlow::memoryStats()
+    {
+        MemoryStats s;
+        MemoryWalk walk{s, {}};
+
+        s.strings += string_heap_bytes(m_name);
+        s.graph += vector_bytes(m_orderForward) + vector_bytes(m_orderBackward) + vector_bytes(m_orderStack) + vector_bytes(m_orderPool);
+        s.graph += vector_bytes(m_links);
+        // Buckets, then one hash node (value and next pointer) per entry
+        s.graph += m_nodes.bucket_count() * sizeof(void*) + m_nodes.size() * (sizeof(decltype(m_nodes)::value_type) + sizeof(void*));
+        s.evaluation += vector_bytes(m_delays) + vector_bytes(m_plan) + vector_bytes(m_passNodes);
+
+        for (auto &n: m_nodes) { n.second->memoryUsage(walk); }
+
+        for (auto &l: m_links) {
+            if (l.expired())
+                continue;
+            s.linkCount++;
+            s.links += sizeof(Link) + shared_block_bytes();
+        }
+
+        if (ImGuiContext* ctx = m_context.getRawContext()) {
+            for (ImGuiWindow* w: ctx->Windows) {
+                if (!w->DrawList)
+                    continue;
+                const ImDrawList& dl = *w->DrawList;
+                s.drawCache += dl.CmdBuffer.Capacity * sizeof(ImDrawCmd) + dl.IdxBuffer.Capacity * sizeof(ImDrawIdx) + dl.VtxBuffer.Capacity * sizeof(ImDrawVert);
+            }
+        }
+        return s;
+    }
+
+    static Pin* findPin(const PinList& pins, PinUID uid) noexcept(true)
+    {
+        for (auto &p: pins) {
+            if (p->getUid() == uid)
+                return p.get();
+        }
+        return nullptr;
+    }
+
+    std::unordered_map<NodeUID, std::shared_ptr<BaseNode>>::iterator ImNodeFlow::eraseNode(std::unordered_map<NodeUID, std::shared_ptr<BaseNode>>::iterator it)
+    {
+        BaseNode* n = it->second.get();
+        beginEdit();
+        // Inputs first: self links then leave both lists
+        for (auto &p: n->m_ins) { p->deleteLink(); }
+        for (auto &p: n->m_dynamicIns) { p.second->deleteLink(); }
+        auto downstream = n->m_downstreamLinks;
+        for (Link* l: downstream) { l->right()->deleteLink(); }
+        for (auto* o: m_observers) o->nodeRemoved(*n);
+        endEdit();
+        graphChanged();
+        return m_nodes.erase(it);
+    }
+
+    bool ImNodeFlow::removeNode(NodeUID uid)
+    {
+        auto it = m_nodes.find(uid);
+        if (it == m_nodes.end())
+            return false;
+        eraseNode(it);
+        return true;
+    }
+
+    bool ImNodeFlow::changeNodeUID(NodeUID uid, NodeUID newUid)
+    {
+        auto it = m_nodes.find(uid);
+        if (it == m_nodes.end() || (newUid != uid && m_nodes.count(newUid)))
+            return false;
+        std::shared_ptr<BaseNode> n = std::move(it->second);
+        m_nodes.erase(it);
+        n->setUID(newUid);
+        m_nodes[newUid] = std::move(n);
+        return true;
+    }
+
+    bool ImNodeFlow::setNextNodeUID(NodeUID uid) noexcept(true)
+    {
+        if (uid != 0 && m_nodes.count(uid))
+            return false;
+        m_nextNodeUID = uid;
+        return true;
+    }
+
+    std::vector<BaseNode*> ImNodeFlow::sortedNodes()
+    {
+        std::vector<BaseNode*> order;
+        order.reserve(m_nodes.size());
+        for (auto &n: m_nodes) { order.push_back(n.second.get()); }
+        std::sort(order.begin(), order.end(), [](const BaseNode* a, const BaseNode* b) { return a->m_topoIndex < b->m_topoIndex; });
+        return order;
+    }
+
+    bool ImNodeFlow::saveBinary(const std::string& path, const NodeTypeOf& typeOf)
+    {
+        return writeBinary(path, typeOf, nullptr);
+    }
+
+    bool ImNodeFlow::saveBinary(const std::string& path, const NodeRegistry& registry)
+    {
+        return writeBinary(path, [&registry](const BaseNode& n) { return registry.typeOf(n); },
+                           [&registry](const BaseNode& n, std::vector<std::byte>& out)
+                           {
+                               const NodeType* t = registry.find(n);
+                               if (t && t->saveState)
+                                   t->saveState(n, out);
+                           });
+    }
+
+    bool ImNodeFlow::loadBinary(const std::string& path, const NodeFactory& factory)
+    {
+        return readBinary(path, factory, nullptr);
+    }
+
+    bool ImNodeFlow::loadBinary(const std::string& path, const NodeRegistry& registry)
+    {
+        return readBinary(path, [&registry](ImNodeFlow& inf, uint32_t type, const ImVec2& pos) { return registry.create(inf, type, pos); },
+                          [&registry](BaseNode& n, std::span<const std::byte> in)
+                          {
+                              const NodeType* t = registry.find(n);
+                              return t && t->loadState && t->loadState(n, in);
+                          });
+    }
+
+    bool ImNodeFlow::writeBinary(const std::string& path, const NodeTypeOf& typeOf, const std::function<void(const BaseNode&, std::vector<std::byte>&)>& saveState)
+    {
+        // Topological order: loading creates the links front to back, without reordering
+        std::vector<BaseNode*> order = sortedNodes();
+        std::unordered_map<const BaseNode*, uint32_t> index;
+        index.reserve(order.size());
+
+        std::vector<BinaryNode> nodes;
+        std::vector<BinaryPin> pins;
+        std::vector<BinaryLink> links;
+        std::string strings;
+        std::vector<std::byte> blobs;
+        std::vector<std::byte> state;
+        nodes.reserve(order.size());
+        links.reserve(m_links.size());
+
+        auto addBlob = [&blobs](std::span<const std::byte> b)
+        {
+            auto offset = static_cast<uint32_t>(blobs.size());
+            blobs.insert(blobs.end(), b.begin(), b.end());
+            blobs.resize((blobs.size() + 7) & ~std::size_t(7));
+            return offset;
+        };
+        auto addPin = [&](const std::shared_ptr<Pin>& p)
+        {
+            auto value = p->defaultBytes();
+            pins.push_back({ p->getUid(), addBlob(value), static_cast<uint32_t>(value.size()), static_cast<uint32_t>(p->getType()), 0 });
+        };
+
+        for (BaseNode* n: order) {
+            index[n] = static_cast<uint32_t>(nodes.size());
+            BinaryNode r{};
+            r.uid = n->getUID();
+            r.type = typeOf(*n);
+            r.x = n->getPos().x;
+            r.y = n->getPos().y;
+            r.title = static_cast<uint32_t>(strings.size());
+            r.titleSize = static_cast<uint32_t>(n->m_title.size());
+            strings += n->m_title;
+            r.firstPin = static_cast<uint32_t>(pins.size());
+            for (auto &p: n->m_ins) { addPin(p); }
+            for (auto &p: n->m_outs) { addPin(p); }
+            r.pinCount = static_cast<uint32_t>(pins.size()) - r.firstPin;
+            if (saveState) {
+                state.clear();
+                saveState(*n, state);
+                r.state = addBlob(state);
+                r.stateSize = static_cast<uint32_t>(state.size());
+            }
+            nodes.push_back(r);
+        }
+
+        for (auto &l: m_links) {
+            auto link = l.lock();
+            if (!link)
+                continue;
+            links.push_back({ link->left()->getUid(), link->right()->getUid(),
+                              index[link->left()->getParent()], index[link->right()->getParent()] });
+        }
+
+        BinaryHeader h;
+        h.nodeCount = static_cast<uint32_t>(nodes.size());
+        h.pinCount = static_cast<uint32_t>(pins.size());
+        h.linkCount = static_cast<uint32_t>(links.size());
+        h.nodes = sizeof(BinaryHeader);
+        h.pins = h.nodes + nodes.size() * sizeof(BinaryNode);
+        h.links = h.pins + pins.size() * sizeof(BinaryPin);
+        h.strings = h.links + links.size() * sizeof(BinaryLink);
+        std::size_t padding = ((h.strings + strings.size() + 7) & ~uint64_t(7)) - (h.strings + strings.size());
+        strings.append(padding, '\0');
+        h.blobs = h.strings + strings.size();
+        h.size = h.blobs + blobs.size();
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(nodes.data()), static_cast<std::streamsize>(nodes.size() * sizeof(BinaryNode)));
+        out.write(reinterpret_cast<const char*>(pins.data()), static_cast<std::streamsize>(pins.size() * sizeof(BinaryPin)));
+        out.write(reinterpret_cast<const char*>(links.data()), static_cast<std::streamsize>(links.size() * sizeof(BinaryLink)));
+        out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        out.write(reinterpret_cast<const char*>(blobs.data()), static_cast<std::streamsize>(blobs.size()));
+        return out.good();
+    }
+
+    bool ImNodeFlow::readBinary(const std::string& path, const NodeFactory& factory, const std::function<bool(BaseNode&, std::span<const std::byte>)>& loadState)
+    {
+        MappedFile file(path);
+        if (!file.isOpen())
+            return false;
+        BinaryGraphView view(file.bytes());
+        if (!view.valid())
+            return false;
+        const BinaryHeader& h = view.header();
+
+        m_nodes.reserve(m_nodes.size() + h.nodeCount);
+        m_links.reserve(m_links.size() + h.linkCount);
+        std::vector<BaseNode*> created(h.nodeCount, nullptr);
+        beginEdit();
+
+        for (uint32_t i = 0; i < h.nodeCount; i++) {
+            BinaryNode r = view.node(i);
+            // Keeps its UID from the file, unless a node of the graph already has it
+            (void)setNextNodeUID(r.uid);
+            std::shared_ptr<BaseNode> n = factory(*this, r.type, ImVec2(r.x, r.y));
+            (void)setNextNodeUID(0);
+            if (!n)
+                continue;
+            created[i] = n.get();
+            if (r.titleSize)
+                n->m_title = view.string(r.title, r.titleSize);
+            for (uint32_t k = 0; k < r.pinCount && uint64_t(r.firstPin) + k < h.pinCount; k++) {
+                BinaryPin p = view.pin(r.firstPin + k);
+                if (p.kind != PinType_Input || !p.valueSize)
+                    continue;
+                if (Pin* in = findPin(n->m_ins, p.uid))
+                    (void)in->setDefaultBytes(view.blob(p.value, p.valueSize));
+            }
+            if (loadState && r.stateSize)
+                (void)loadState(*n, view.blob(r.state, r.stateSize));
+        }
+
+        for (uint32_t i = 0; i < h.linkCount; i++) {
+            BinaryLink r = view.link(i);
+            if (r.leftNode >= h.nodeCount || r.rightNode >= h.nodeCount || !created[r.leftNode] || !created[r.rightNode])
+                continue;
+            Pin* out = findPin(created[r.leftNode]->m_outs, r.leftPin);
+            Pin* in = findPin(created[r.rightNode]->m_ins, r.rightPin);
+            if (out && in)
+                in->createLink(out);
+        }
+        endEdit();
+        return true;
+    }
+
+    bool ImNodeFlow::exportJson(std::ostream& out, const NodeRegistry& registry)
+    {
+        JsonWriter w(out);
+        std::vector<std::byte> state;
+        w.beginObject().key("format").string("imnodeflow").key("version").integer(1);
+
+        auto writePin = [&w](const std::shared_ptr<Pin>& p)
+        {
+            w.beginObject().key("uid").uinteger(p->getUid()).key("name").string(p->getName());
+            w.key("kind").string(p->getType() == PinType_Input ? "in" : "out");
+            if (auto value = p->defaultBytes(); !value.empty())
+                w.key("default").hex(value);
+            w.endObject();
+        };
+
+        // Topological order: importing creates the links front to back, without reordering
+        w.key("nodes").beginArray();
+        for (BaseNode* n: sortedNodes()) {
+            const NodeType* t = registry.find(*n);
+            w.lineBreak().beginObject();
+            w.key("uid").uinteger(n->getUID());
+            w.key("type").uinteger(t ? t->id : NodeRegistry::unknown);
+            if (t && !t->name.empty())
+                w.key("typeName").string(t->name);
+            w.key("title").string(n->m_title);
+            w.key("pos").beginArray().number(n->getPos().x).number(n->getPos().y).endArray();
+            w.key("pins").beginArray();
+            for (auto &p: n->m_ins) { writePin(p); }
+            for (auto &p: n->m_outs) { writePin(p); }
+            w.endArray();
+            if (t && t->writeJson) {
+                w.key("state");
+                t->writeJson(*n, w);
+            } else if (t && t->saveState) {
+                state.clear();
+                t->saveState(*n, state);
+                if (!state.empty())
+                    w.key("state").hex(state);
+            }
+            w.endObject();
+        }
+        w.lineBreak().endArray();
+
+        w.key("links").beginArray();
+        for (auto &l: m_links) {
+            auto link = l.lock();
+            if (!link)
+                continue;
+            w.lineBreak().beginObject();
+            w.key("from").beginArray().uinteger(link->left()->getParent()->getUID()).uinteger(link->left()->getUid()).endArray();
+            w.key("to").beginArray().uinteger(link->right()->getParent()->getUID()).uinteger(link->right()->getUid()).endArray();
+            w.endObject();
+        }
+        w.lineBreak().endArray();
+        w.endObject();
+        out.put('\n');
+        return out.good();
+    }
+
+    bool ImNodeFlow::importJson(std::istream& in, const NodeRegistry& registry)
+    {
+        JsonReader r(in);
+        std::unordered_map<NodeUID, BaseNode*> remap;
+        if (r.next() != JsonToken_ObjectBegin)
+            return false;
+
+        beginEdit();
+        bool ok = readJsonDocument(r, registry, remap);
+        endEdit();
+        return ok;
+    }
+
+    bool ImNodeFlow::readJsonDocument(JsonReader& r, const NodeRegistry& registry, std::unordered_map<NodeUID, BaseNode*>& remap)
+    {
+        while (true) {
+            JsonToken t = r.next();
+            if (t == JsonToken_ObjectEnd)
+                break;
+            if (t != JsonToken_Key)
+                return false;
+
+            bool nodes = r.text() == "nodes";
+            if (!nodes && r.text() != "links") {
+                if (!r.skipValue())
+                    return false;
+                continue;
+            }
+            if (r.next() != JsonToken_ArrayBegin)
+                return false;
+            while ((t = r.next()) == JsonToken_ObjectBegin) {
+                if (!(nodes ? readJsonNode(r, registry, remap) : readJsonLink(r, remap)))
+                    return false;
+            }
+            if (t != JsonToken_ArrayEnd)
+                return false;
+        }
+        return r.next() == JsonToken_End;
+    }
+
+    bool ImNodeFlow::readJsonNode(JsonReader& r, const NodeRegistry& registry, std::unordered_map<NodeUID, BaseNode*>& remap)
+    {
+        NodeUID uid = 0;
+        uint32_t type = NodeRegistry::unknown;
+        ImVec2 pos;
+        std::string title;
+        bool hasTitle = false;
+        std::vector<std::byte> bytes;
+
+        // Created once the members it depends on are read: the writer puts them first
+        const NodeType* nt = nullptr;
+        std::shared_ptr<BaseNode> node;
+        bool created = false;
+        auto create = [&]()
+        {
+            if (created)
+                return;
+            created = true;
+            nt = registry.find(type);
+            node = nt ? nt->create(*this, pos) : nullptr;
+            if (node)
+                remap[uid] = node.get();
+        };
+
+        while (true) {
+            JsonToken t = r.next();
+            if (t == JsonToken_ObjectEnd)
+                break;
+            if (t != JsonToken_Key)
+                return false;
+
+            if (r.text() == "uid" || r.text() == "type") {
+                bool isUid = r.text() == "uid";
+                if (r.next() != JsonToken_Number)
+                    return false;
+                if (isUid)
+                    uid = static_cast<NodeUID>(r.uinteger());
+                else
+                    type = static_cast<uint32_t>(r.uinteger());
+            } else if (r.text() == "pos") {
+                if (r.next() != JsonToken_ArrayBegin || r.next() != JsonToken_Number)
+                    return false;
+                pos.x = static_cast<float>(r.number());
+                if (r.next() != JsonToken_Number)
+                    return false;
+                pos.y = static_cast<float>(r.number());
+                if (r.next() != JsonToken_ArrayEnd)
+                    return false;
+            } else if (r.text() == "title") {
+                if (r.next() != JsonToken_String)
+                    return false;
+                title = r.text();
+                hasTitle = true;
+            } else if (r.text() == "pins") {
+                create();
+                if (r.next() != JsonToken_ArrayBegin)
+                    return false;
+                while ((t = r.next()) == JsonToken_ObjectBegin) {
+                    PinUID pin = 0;
+                    bool input = false;
+                    bytes.clear();
+                    while ((t = r.next()) == JsonToken_Key) {
+                        if (r.text() == "uid") {
+                            if (r.next() != JsonToken_Number)
+                                return false;
+                            pin = r.uinteger();
+                        } else if (r.text() == "kind") {
+                            if (r.next() != JsonToken_String)
+                                return false;
+                            input = r.text() == "in";
+                        } else if (r.text() == "default") {
+                            if (r.next() != JsonToken_String || !r.hex(bytes))
+                                return false;
+                        } else if (!r.skipValue()) {
+                            return false;
+                        }
+                    }
+                    if (t != JsonToken_ObjectEnd)
+                        return false;
+                    Pin* p = node && input && !bytes.empty() ? findPin(node->m_ins, pin) : nullptr;
+                    if (p)
+                        (void)p->setDefaultBytes(bytes);
+                }
+                if (t != JsonToken_ArrayEnd)
+                    return false;
+            } else if (r.text() == "state") {
+                create();
+                if (node && nt->readJson) {
+                    (void)nt->readJson(*node, r);
+                    if (r.failed())
+                        return false;
+                    continue;
+                }
+                t = r.next();
+                bytes.clear();
+                if (t == JsonToken_String && node && nt->loadState && r.hex(bytes))
+                    (void)nt->loadState(*node, bytes);
+                else if ((t == JsonToken_ObjectBegin || t == JsonToken_ArrayBegin) && !r.skipValue(1))
+                    return false;
+                else if (t == JsonToken_Error)
+                    return false;
+            } else if (!r.skipValue()) {
+                return false;
+            }
+        }
+
+        create();
+        if (node && hasTitle)
+            node->m_title = std::move(title);
+        return true;
+    }
+
+    bool ImNodeFlow::readJsonLink(JsonReader& r, const std::unordered_map<NodeUID, BaseNode*>& remap)
+    {
+        uint64_t ends[2][2] = {};
+        JsonToken t;
+        while ((t = r.next()) == JsonToken_Key) {
+            int end = r.text() == "from" ? 0 : r.text() == "to" ? 1 : -1;
+            if (end < 0) {
+                if (!r.skipValue())
+                    return false;
+                continue;
+            }
+            if (r.next() != JsonToken_ArrayBegin || r.next() != JsonToken_Number)
+                return false;
+            ends[end][0] = r.uinteger();
+            if (r.next() != JsonToken_Number)
+                return false;
+            ends[end][1] = r.uinteger();
+            if (r.next() != JsonToken_ArrayEnd)
+                return false;
+        }
+        if (t != JsonToken_ObjectEnd)
+            return false;
+
+        auto left = remap.find(static_cast<NodeUID>(ends[0][0]));
+        auto right = remap.find(static_cast<NodeUID>(ends[1][0]));
+        if (left == remap.end() || right == remap.end())
+            return true;
+        Pin* out = findPin(left->second->m_outs, ends[0][1]);
+        Pin* in = findPin(right->second->m_ins, ends[1][1]);
+        if (out && in)
+            in->createLink(out);
+        return true;
+    }
+
+    GraphInstances ImNodeFlow::instantiate(std::size_t count)
+    {
+        GraphInstances g;
+        g.m_count = count;
+
+        for (auto &n: m_nodes) {
+            if (n.second->isBatchProcessor())
+                g.m_steps.push_back({n.second, n.second->m_batchProcess, {}});
+        }
+        std::sort(g.m_steps.begin(), g.m_steps.end(),
+                  [](const GraphInstances::Step& a, const GraphInstances::Step& b) { return a.node->m_topoIndex < b.node->m_topoIndex; });
+
+        // Outputs own their column. Inputs share the column of their output, or own one when fed by another kind of node
+        std::unordered_map<Pin*, bool> batchOut;
+        for (auto &s: g.m_steps) {
+            for (auto &p: s.node->m_outs) { batchOut[p.get()] = true; }
+        }
+        auto source = [&batchOut](const std::shared_ptr<Pin>& in) -> Pin*
+        {
+            auto link = in->getLink().lock();
+            return link && batchOut.count(link->left()) ? link->left() : nullptr;
+        };
+        auto stride = [count](const Pin* p) { return (p->columnSize() * count + 63) & ~std::size_t(63); };
+
+        std::vector<Pin*> owners;
+        std::size_t bytes = 0, ins = 0, outs = 0;
+        for (auto &s: g.m_steps) {
+            for (auto &p: s.node->m_outs) { owners.push_back(p.get()); }
+            for (auto &p: s.node->m_ins) {
+                if (!source(p))
+                    owners.push_back(p.get());
+            }
+            ins += s.node->m_ins.size();
+            outs += s.node->m_outs.size();
+        }
+        for (Pin* p : owners) {
+            bytes += stride(p);
+            g.m_bytesPerInstance += p->columnSize();
+        }
+
+        g.m_pool = std::make_unique<std::byte[]>(bytes + 64);
+        auto base = reinterpret_cast<std::uintptr_t>(g.m_pool.get());
+        auto* next = g.m_pool.get() + ((64 - base % 64) % 64);
+        for (Pin* p : owners) {
+            BatchColumn c;
+            if (p->columnSize()) {
+                c = {next, &p->getDataType()};
+                p->fillColumn(next, count);
+            }
+            g.m_columns[p] = c;
+            next += stride(p);
+        }
+
+        // Sized once: the spans below point into these
+        g.m_ins.reserve(ins);
+        g.m_outs.reserve(outs);
+        for (auto &s: g.m_steps) {
+            std::size_t firstIn = g.m_ins.size(), firstOut = g.m_outs.size();
+            for (auto &p: s.node->m_ins) {
+                Pin* left = source(p);
+                g.m_ins.push_back(g.m_columns[left ? left : p.get()]);
+                if (left)
+                    g.m_columns[p.get()] = g.m_ins.back();
+            }
+            for (auto &p: s.node->m_outs) { g.m_outs.push_back(g.m_columns[p.get()]); }
+            s.io.m_ins = std::span<const BatchColumn>(g.m_ins.data() + firstIn, g.m_ins.size() - firstIn);
+            s.io.m_outs = std::span<const BatchColumn>(g.m_outs.data() + firstOut, g.m_outs.size() - firstOut);
+        }
+        return g;
+    }
+
+    void ImNodeFlow::publish(BaseNode* node, uint8_t slot) noexcept(true)
+    {
+        for (auto &p: node->m_outs) { p->publish(slot); }
+        for (auto &p: node->m_dynamicOuts) { p.second->publish(slot); }
+        node->m_evalPublished[slot] = node->m_evalStats;
+    }
+
+    void ImNodeFlow::seed(BaseNode* node)
+    {
+        for (auto &p: node->m_outs) { p->seedSnapshot(); }
+        for (auto &p: node->m_dynamicOuts) { p.second->seedSnapshot(); }
+        node->m_evalPublished.fill(node->m_evalStats);
+    }
+
+    void ImNodeFlow::evaluatorLoop(const std::stop_token& stop, std::chrono::microseconds period)
+    {
+        while (!stop.stop_requested())
+        {
+            auto start = std::chrono::steady_clock::now();
+            std::unique_lock lock(m_graphMutex);
+            IMFLOW_TRACE_SCOPE("Evaluator pass");
+
+            bool complete = false;
+            while (!complete && !stop.stop_requested())
+            {
+                uint64_t version = m_graphVersion;
+                m_passNodes.clear();
+                if (m_sinkDriven)
+                    m_passNodes.assign(getEvaluationPlan().begin(), getEvaluationPlan().end());
+                else
+                    for (auto &n: m_nodes) { m_passNodes.push_back(n.second.get()); }
+
+                // Values computed before a restart are kept: they are stamped with the same evaluation frame
+                complete = true;
+                for (BaseNode* n : m_passNodes) {
+                    if (m_graphWaiters.load(std::memory_order_relaxed) > 0) {
+                        lock.unlock();
+                        while (m_graphWaiters.load(std::memory_order_acquire) > 0)
+                            std::this_thread::yield();
+                        lock.lock();
+                        if (version != m_graphVersion) {
+                            complete = false;
+                            break;
+                        }
+                    }
+                    for (auto &p: n->m_outs) { p->resolve(); }
+                    for (auto &p: n->m_dynamicOuts) { p.second->resolve(); }
+                }
+            }
+            if (!complete)
+                break;
+
+            // Publish the whole pass at once
+            for (auto &n: m_nodes) { publish(n.second.get(), m_snapshotBack); }
+            m_snapshotBack = m_snapshotMiddle.exchange(m_snapshotBack | 4, std::memory_order_acq_rel) & 3;
+            finishEvaluation();
+
+            lock.unlock();
+            std::this_thread::sleep_until(start + period);
+        }
+    }
 
     void ImNodeFlow::update() noexcept(true)
     {
+        IMFLOW_TRACE_SCOPE("ImNodeFlow::update");
+        IMFLOW_TRACE_PHASES(phase, "Commands");
+        AllocStats allocStart = thread_allocation_stats();
+
         // Updating looping stuff
         m_hovering       = nullptr;
         m_hoveredNode    = nullptr;
         m_draggingNode   = m_draggingNodeNext;
         m_singleUseClick = ImGui::IsMouseClicked(ImGuiMouseButton_Left);
 
+        // While the evaluator runs, the graph is only taken around the structural phases, which share the wait.
+        // If the evaluator is stuck in a slow node meanwhile, they are left to the next frame
+        bool readSnapshot = isEvaluatorRunning();
+        auto graphDeadline = std::chrono::steady_clock::now() + m_graphWait;
+        auto takeGraph = [this, readSnapshot, graphDeadline]()
+        {
+            if (!readSnapshot)
+                return lockGraph();
+            auto left = std::chrono::duration_cast<std::chrono::microseconds>(graphDeadline - std::chrono::steady_clock::now());
+            return tryLockGraph(std::max(left, std::chrono::microseconds(0)));
+        };
+        auto graphLock = takeGraph();
+        beginEdit();
+
+        if (graphLock.owns_lock()) {
+            // Apply the mutations posted by other threads
+            m_commands.drain(*this);
+
+            // Free the block plan the processing thread let go, and hand it a new one if the graph changed
+            tagged_delete<AllocTag_Evaluation>(m_blockRetired.exchange(nullptr, std::memory_order_acq_rel));
+            if (m_blockSize && m_blockVersion != m_graphVersion) {
+                m_blockVersion = m_graphVersion;
+                tagged_delete<AllocTag_Evaluation>(m_blockPending.exchange(compileBlockPlan(), std::memory_order_acq_rel));
+            }
+        }
+        const ImNodeFlow* outerReader = readSnapshot ? std::exchange(m_snapshotReader, this) : m_snapshotReader;
+        if (readSnapshot && (m_snapshotMiddle.load(std::memory_order_relaxed) & 4))
+            m_snapshotFront = m_snapshotMiddle.exchange(m_snapshotFront, std::memory_order_acq_rel) & 3;
+
+        // Resume the coroutines that are ready
+        IMFLOW_TRACE_NEXT(phase, "Coroutines");
+        if (graphLock.owns_lock())
+            m_scheduler.tick();
+
+        // Drawn from the snapshot, alongside the evaluator: graph edits are staged meanwhile
+        if (readSnapshot && graphLock.owns_lock())
+            graphLock.unlock();
+
         // Create child canvas
+        IMFLOW_TRACE_NEXT(phase, "Context begin");
         m_context.begin();
         ImGui::GetIO().IniFilename = nullptr;
 
         ImDrawList *draw_list = ImGui::GetWindowDrawList();
 
+        IMFLOW_TRACE_NEXT(phase, "Grid");
         if ( m_context.config().grid_enabled == true )
         {
           // Display grid
@@ -286,24 +1499,26 @@ namespace ImFlow {
           }
         } /* if ( m_context.config().grid_enabled == true ) */
 
+        // Evaluate sinks ahead of drawing
+        IMFLOW_TRACE_NEXT(phase, "Evaluate sinks");
+        if (m_sinkDriven && !readSnapshot)
+            evaluate();
+
         // Update and draw nodes
         // TODO: I don't like this
+        IMFLOW_TRACE_NEXT(phase, "Nodes update");
         draw_list->ChannelsSplit(2);
         for (auto &node: m_nodes) { node.second->update(); }
-        // Remove "toDelete" nodes
-        for (auto iter = m_nodes.begin(); iter != m_nodes.end();) {
-            if (iter->second->toDestroy())
-                iter = m_nodes.erase(iter);
-            else
-                ++iter;
-        }
+        IMFLOW_TRACE_NEXT(phase, "ChannelsMerge");
         draw_list->ChannelsMerge();
         for (auto &node: m_nodes) { node.second->updatePublicStatus(); }
 
         // Update and draw links
+        IMFLOW_TRACE_NEXT(phase, "Links update");
         for (auto &l: m_links) { if (!l.expired()) l.lock()->update(); }
 
         // Links drop-off
+        IMFLOW_TRACE_NEXT(phase, "Links drop and drag");
         if (m_dragOut && ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
             if (!m_hovering) {
                 if (on_free_space() && m_droppedLinkPopUp) {
@@ -312,7 +1527,9 @@ namespace ImFlow {
                         ImGui::OpenPopup("DroppedLinkPopUp");
                     }
                 }
-            } else
+            } else if (readSnapshot)
+                postLinkEdit(m_dragOut, m_hovering, true);
+            else
                 m_dragOut->createLink(m_hovering);
         }
 
@@ -332,28 +1549,143 @@ namespace ImFlow {
         }
 
         // Right-click PopUp
+        IMFLOW_TRACE_NEXT(phase, "Pop-ups");
         if (m_rightClickPopUp && ImGui::IsMouseClicked(ImGuiMouseButton_Right) && ImGui::IsWindowHovered()) {
             m_hoveredNodeAux = m_hoveredNode;
             ImGui::OpenPopup("RightClickPopUp");
         }
-        if (ImGui::BeginPopup("RightClickPopUp")) {
-            m_rightClickPopUp(m_hoveredNodeAux);
-            ImGui::EndPopup();
-        }
 
-        // Dropped Link PopUp
-        if (ImGui::BeginPopup("DroppedLinkPopUp")) {
-            m_droppedLinkPopUp(m_droppedLinkLeft);
-            ImGui::EndPopup();
+        // Take the graph back for the edits of the frame. Pop-ups may edit it too: without the graph they stay open, but hidden
+        if (!graphLock.owns_lock())
+            graphLock = takeGraph();
+        if (graphLock.owns_lock()) {
+            if (ImGui::BeginPopup("RightClickPopUp")) {
+                m_rightClickPopUp(m_hoveredNodeAux);
+                ImGui::EndPopup();
+            }
+
+            // Dropped Link PopUp
+            if (ImGui::BeginPopup("DroppedLinkPopUp")) {
+                m_droppedLinkPopUp(m_droppedLinkLeft);
+                ImGui::EndPopup();
+            }
+
+            // Staged edits, then the pins that weren't shown and the "toDelete" nodes
+            IMFLOW_TRACE_NEXT(phase, "Nodes destroy");
+            applyLinkEdits();
+            for (auto &node: m_nodes) { node.second->sweepPins(); }
+            for (auto iter = m_nodes.begin(); iter != m_nodes.end();) {
+                if (iter->second->toDestroy())
+                    iter = eraseNode(iter);
+                else
+                    ++iter;
+            }
+
+            // Removing dead Links
+            IMFLOW_TRACE_NEXT(phase, "Dead links removal");
+            m_links.erase(std::remove_if(m_links.begin(), m_links.end(),
+                                         [](const std::weak_ptr<Link> &l) { return l.expired(); }), m_links.end());
         }
 
-        // Removing dead Links
-        m_links.erase(std::remove_if(m_links.begin(), m_links.end(),
-                                     [](const std::weak_ptr<Link> &l) { return l.expired(); }), m_links.end());
+        // Heat-map scale for the next frame
+        if (m_profileOverlay) {
+            m_profileMax = 0;
+            for (auto &n: m_nodes) { m_profileMax = std::max(m_profileMax, n.second->getShownEvalStats().ns + n.second->m_drawStats.ns); }
+        }
 
-        // Clearing recursion blacklist
-        m_pinRecursionBlacklist.clear();
+        // Commit delays and move to the next evaluation frame
+        IMFLOW_TRACE_NEXT(phase, "Finish evaluation");
+        if (!readSnapshot)
+            finishEvaluation();
+        m_snapshotReader = outerReader;
 
+        IMFLOW_TRACE_NEXT(phase, "Context end");
         m_context.end();
+        endEdit();
+
+        m_frameAllocs = thread_allocation_stats() - allocStart;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // NODE REGISTRY
+
+    NodeRegistry& node_registry()
+    {
+        static NodeRegistry registry;
+        return registry;
+    }
+
+    const NodeType* NodeRegistry::find(const BaseNode& node) const noexcept(true)
+    {
+        auto it = m_ids.find(std::type_index(typeid(node)));
+        return it != m_ids.end() ? find(it->second) : nullptr;
+    }
+
+    std::shared_ptr<BaseNode> NodeRegistry::clone(ImNodeFlow& inf, const BaseNode& prototype, const ImVec2& pos) const
+    {
+        const NodeType* t = find(prototype);
+        if (!t)
+            return nullptr;
+        std::shared_ptr<BaseNode> n = t->create(inf, pos);
+        if (!n)
+            return nullptr;
+
+        n->m_title = prototype.m_title;
+        n->m_style = prototype.m_style;
+        // Pins are declared by the constructor, in the same order for every node of the type
+        for (std::size_t i = 0; i < std::min(n->m_ins.size(), prototype.m_ins.size()); i++) {
+            Pin& src = *prototype.m_ins[i];
+            Pin& dst = *n->m_ins[i];
+            if (src.getUid() != dst.getUid())
+                continue;
+            dst.getStyle() = src.getStyle();
+            (void)dst.setDefaultBytes(src.defaultBytes());
+        }
+        for (std::size_t i = 0; i < std::min(n->m_outs.size(), prototype.m_outs.size()); i++) {
+            if (prototype.m_outs[i]->getUid() == n->m_outs[i]->getUid())
+                n->m_outs[i]->getStyle() = prototype.m_outs[i]->getStyle();
+        }
+
+        if (t->saveState && t->loadState) {
+            std::vector<std::byte> state;
+            t->saveState(prototype, state);
+            (void)t->loadState(*n, state);
+        }
+        return n;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // PARAMETER SWEEP
+
+    GraphInstances ParameterSweep::run(ImNodeFlow& inf, ThreadPool& pool, std::size_t chunk) const
+    {
+        std::size_t points = size();
+        GraphInstances g = inf.instantiate(points);
+        if (points == 0)
+            return g;
+        chunk = std::max<std::size_t>(chunk, 1);
+
+        std::vector<std::size_t> strides;
+        std::size_t stride = 1;
+        for (auto &a: m_axes) {
+            strides.push_back(m_mode == SweepMode_Grid ? stride : 1);
+            stride *= a.size;
+        }
+
+        // Chunks write disjoint rows of the columns
+        std::size_t chunks = (points + chunk - 1) / chunk;
+        std::latch done(static_cast<std::ptrdiff_t>(chunks));
+        for (std::size_t first = 0; first < points; first += chunk) {
+            std::size_t count = std::min(chunk, points - first);
+            pool.submit([this, &g, &strides, &done, first, count]()
+            {
+                for (std::size_t i = 0; i < m_axes.size(); i++)
+                    m_axes[i].fill(g, first, count, strides[i]);
+                g.evaluate(first, count);
+                done.count_down();
+            });
+        }
+        done.wait();
+        return g;
     }
 }
@@ -31,6 +31,13 @@ namespace ImFlow
         return ImProjectOnCubicBezier(p, p1, p11, p22, p2).Distance < radius;
     }
 
+    inline ImU32 heat_tint(ImU32 color, float heat)
+    {
+        ImVec4 base = ImGui::ColorConvertU32ToFloat4(color);
+        ImVec4 hot = ImVec4(0.9f, 0.15f, 0.05f, base.w);
+        return ImGui::ColorConvertFloat4ToU32(ImLerp(base, hot, std::clamp(heat, 0.f, 1.f)));
+    }
+
     // -----------------------------------------------------------------------------------------------------------------
     // HANDLER
 
@@ -39,13 +46,28 @@ namespace ImFlow
     {
         static_assert(std::is_base_of<BaseNode, T>::value, "Pushed type is not a subclass of BaseNode!");
 
-        std::shared_ptr<T> n = std::make_shared<T>(std::forward<Params>(args)...);
+        std::shared_ptr<T> n = std::allocate_shared<T>(TaggedAllocator<T, AllocTag_Nodes>{}, std::forward<Params>(args)...);
+        n->m_footprint = sizeof(T);
         n->setPos(pos);
         n->setHandler(this);
+        n->m_topoIndex = m_nextTopoIndex++;
         if (!n->getStyle())
             n->setStyle(NodeStyle::cyan());
-        
+        for (auto& p : n->getOuts())
+            if (p->isDelay())
+                addDelay(p);
+        if (isEvaluatorRunning())
+            seed(n.get());
+        graphChanged();
+
+        // UIDs restored from files (see setNextNodeUID()) or reserved may collide with the address of a new node
+        if (NodeUID uid = std::exchange(m_nextNodeUID, 0); uid != 0 && !m_nodes.count(uid))
+            n->setUID(uid);
+        else
+            while (m_nodes.count(n->getUID()) || (m_reservedUIDs && m_reservedUIDs(n->getUID())))
+                n->setUID(n->getUID() + 1);
         m_nodes[n->getUID()] = n;
+        for (auto* o: m_observers) o->nodeAdded(*n);
 
         return n;
     }
@@ -62,9 +84,38 @@ namespace ImFlow
         return placeNodeAt<T>(ImGui::GetMousePos(), std::forward<Params>(args)...);
     }
 
+    template<typename F>
+    auto ImNodeFlow::post(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>&, ImNodeFlow&>>
+    {
+        auto* c = new PostedCommand<std::decay_t<F>>(std::forward<F>(fn));
+        auto f = c->promise.get_future();
+        m_commands.push(c);
+        return f;
+    }
+
+    template<typename T, typename... Params>
+    std::future<std::shared_ptr<T>> ImNodeFlow::postNode(const ImVec2& pos, Params&&... args)
+    {
+        return post([pos, ...args = std::forward<Params>(args)](ImNodeFlow& inf) mutable
+                    { return inf.addNode<T>(pos, std::move(args)...); });
+    }
+
     // -----------------------------------------------------------------------------------------------------------------
     // BASE NODE
 
+    inline BaseNode* BaseNode::setSink(bool state) noexcept(true)
+    {
+        m_sink = state;
+        if (m_inf)
+            m_inf->invalidatePlan();
+        return this;
+    }
+
+    inline bool BaseNode::isLive() const noexcept(true)
+    {
+        return !m_inf || !m_inf->isSinkDriven() || m_planMark == m_inf->getPlanEpoch();
+    }
+
     template<typename T>
     std::shared_ptr<InPin<T>> BaseNode::addIN(const std::string& name, T defReturn, std::function<bool(Pin*, Pin*)> filter, std::shared_ptr<PinStyle> style) noexcept(true)
     {
@@ -75,7 +126,7 @@ namespace ImFlow
     std::shared_ptr<InPin<T>> BaseNode::addIN_uid(const U& uid, const std::string& name, T defReturn, std::function<bool(Pin*, Pin*)> filter, std::shared_ptr<PinStyle> style) noexcept(true)
     {
         PinUID h = std::hash<U>{}(uid);
-        auto p = std::make_shared<InPin<T>>(h, name, defReturn, std::move(filter), std::move(style), this, &m_inf);
+        auto p = std::allocate_shared<InPin<T>>(TaggedAllocator<InPin<T>, AllocTag_Pins>{}, h, name, defReturn, std::move(filter), std::move(style), this, &m_inf);
         m_ins.emplace_back(p);
         return p;
     }
@@ -117,9 +168,19 @@ namespace ImFlow
                 return static_cast<InPin<T>*>(p.second.get())->val();
             }
         }
+        for (std::pair<int, std::shared_ptr<Pin>>& p : m_stagedPins)
+        {
+            if (p.second->getType() == PinType_Input && p.second->getUid() == h)
+            {
+                p.first = 1;
+                return static_cast<InPin<T>*>(p.second.get())->val();
+            }
+        }
 
-        m_dynamicIns.emplace_back(std::make_pair(1, std::make_shared<InPin<T>>(h, name, defReturn, std::move(filter), std::move(style), this, &m_inf)));
-        return static_cast<InPin<T>*>(m_dynamicIns.back().second.get())->val();
+        // The pin lists are read by the evaluator: new pins wait for the structural phase of update()
+        auto& pins = m_inf && m_inf->readsSnapshot() ? m_stagedPins : m_dynamicIns;
+        pins.emplace_back(std::make_pair(1, std::allocate_shared<InPin<T>>(TaggedAllocator<InPin<T>, AllocTag_Pins>{}, h, name, defReturn, std::move(filter), std::move(style), this, &m_inf)));
+        return static_cast<InPin<T>*>(pins.back().second.get())->val();
     }
 
     template<typename T>
@@ -132,11 +193,28 @@ namespace ImFlow
     std::shared_ptr<OutPin<T>> BaseNode::addOUT_uid(const U& uid, const std::string& name, std::shared_ptr<PinStyle> style) noexcept(true)
     {
         PinUID h = std::hash<U>{}(uid);
-        auto p = std::make_shared<OutPin<T>>(h, name, std::move(style), this, &m_inf);
+        auto p = std::allocate_shared<OutPin<T>>(TaggedAllocator<OutPin<T>, AllocTag_Pins>{}, h, name, std::move(style), this, &m_inf);
         m_outs.emplace_back(p);
         return p;
     }
 
+    template<typename T>
+    std::shared_ptr<OutPin<T>> BaseNode::addDelayOUT(const std::string& name, T initial, std::shared_ptr<PinStyle> style) noexcept(true)
+    {
+        return addDelayOUT_uid<T>(name, name, std::move(initial), std::move(style));
+    }
+
+    template<typename T, typename U>
+    std::shared_ptr<OutPin<T>> BaseNode::addDelayOUT_uid(const U& uid, const std::string& name, T initial, std::shared_ptr<PinStyle> style) noexcept(true)
+    {
+        auto p = addOUT_uid<T>(uid, name, std::move(style));
+        p->delay(std::move(initial));
+        // Nodes not yet in a handler get their delays registered by addNode()
+        if (m_inf)
+            m_inf->addDelay(p);
+        return p;
+    }
+
     template<typename U>
     void BaseNode::dropOUT(const U& uid) noexcept(true)
     {
@@ -171,13 +249,28 @@ namespace ImFlow
             if (p.second->getUid() == h)
             {
                 p.first = 2;
-                static_cast<OutPin<T>*>(m_dynamicOuts.back().second.get())->behaviour(std::move(behaviour));
+                // The evaluator may be running the current behaviour
+                if (m_inf && m_inf->readsSnapshot())
+                    static_cast<OutPin<T>*>(p.second.get())->stageBehaviour(std::move(behaviour));
+                else
+                    static_cast<OutPin<T>*>(p.second.get())->behaviour(std::move(behaviour));
+                return;
+            }
+        }
+        for (std::pair<int, std::shared_ptr<Pin>>& p : m_stagedPins)
+        {
+            if (p.second->getType() == PinType_Output && p.second->getUid() == h)
+            {
+                p.first = 2;
+                static_cast<OutPin<T>*>(p.second.get())->behaviour(std::move(behaviour));
                 return;
             }
         }
 
-        m_dynamicOuts.emplace_back(std::make_pair(2, std::make_shared<OutPin<T>>(h, name, std::move(style), this, &m_inf)));
-        static_cast<OutPin<T>*>(m_dynamicOuts.back().second.get())->behaviour(std::move(behaviour));
+        // The pin lists are read by the evaluator: new pins wait for the structural phase of update()
+        auto& pins = m_inf && m_inf->readsSnapshot() ? m_stagedPins : m_dynamicOuts;
+        pins.emplace_back(std::make_pair(2, std::allocate_shared<OutPin<T>>(TaggedAllocator<OutPin<T>, AllocTag_Pins>{}, h, name, std::move(style), this, &m_inf)));
+        static_cast<OutPin<T>*>(pins.back().second.get())->behaviour(std::move(behaviour));
     }
 
     template<typename T, typename U>
@@ -196,6 +289,47 @@ namespace ImFlow
         return getInVal<T, std::string>(uid);
     }
 
+    inline bool BaseNode::hashIns(std::size_t& seed) noexcept(true)
+    {
+        for (auto& p : m_ins)
+            if (!p->hashValue(seed))
+                return false;
+        // Shown or hidden from draw(): which ones are there is part of the key
+        for (auto& p : m_dynamicIns)
+        {
+            hash_combine(seed, p.second->getUid());
+            if (!p.second->hashValue(seed))
+                return false;
+        }
+        return true;
+    }
+
+    inline bool BaseNode::holdIns(HeldValues& out) noexcept(true)
+    {
+        out.reserve(m_ins.size() + m_dynamicIns.size());
+        for (auto& p : m_ins)
+            if (!p->holdValue(out))
+                return false;
+        for (auto& p : m_dynamicIns)
+            if (!p.second->holdValue(out))
+                return false;
+        return true;
+    }
+
+    inline bool BaseNode::matchIns(const HeldValues& held) noexcept(true)
+    {
+        if (held.size() != m_ins.size() + m_dynamicIns.size())
+            return false;
+        std::size_t i = 0;
+        for (auto& p : m_ins)
+            if (!p->matchValue(held[i++]))
+                return false;
+        for (auto& p : m_dynamicIns)
+            if (!p.second->matchValue(held[i++]))
+                return false;
+        return true;
+    }
+
     template<typename U>
     Pin* BaseNode::inPin(const U& uid) noexcept(true)
     {
@@ -297,6 +431,58 @@ namespace ImFlow
         return reinterpret_cast<OutPin<T>*>(m_link->left())->val();
     }
 
+    template<class T>
+    bool InPin<T>::hashValue(std::size_t& seed) noexcept(true)
+    {
+        if (m_hasher)
+        {
+            hash_combine(seed, m_hasher(val()));
+            return true;
+        }
+        if constexpr (requires(const T& v) { std::hash<T>{}(v); })
+        {
+            hash_combine(seed, std::hash<T>{}(val()));
+            return true;
+        }
+        return false;
+    }
+
+    template<class T>
+    bool InPin<T>::holdValue(HeldValues& out) noexcept(true)
+    {
+        if constexpr (std::is_copy_constructible_v<T> && std::equality_comparable<T>)
+        {
+            out.push_back({getUid(), &typeid(T), std::allocate_shared<T>(TaggedAllocator<T, AllocTag_Evaluation>{}, val())});
+            return true;
+        }
+        return false;
+    }
+
+    template<class T>
+    bool InPin<T>::matchValue(const HeldValue& held) noexcept(true)
+    {
+        if constexpr (std::equality_comparable<T>)
+            return held.pin == getUid() && *held.type == typeid(T) && *static_cast<const T*>(held.value.get()) == val();
+        return false;
+    }
+
+    template<class T>
+    void InPin<T>::fillColumn(std::byte* dst, std::size_t count) noexcept(true)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+            std::uninitialized_fill_n(reinterpret_cast<T*>(dst), count, val());
+    }
+
+    template<class T>
+    void InPin<T>::memoryUsage(MemoryWalk& walk) const
+    {
+        countMemory(walk, sizeof(*this));
+        walk.stats.pins -= sizeof(m_filter);
+        walk.stats.functions += sizeof(m_filter);
+        if (m_stream)
+            walk.stats.evaluation += m_stream->footprint();
+    }
+
     template<class T>
     void InPin<T>::createLink(Pin *other) noexcept(true)
     {
@@ -315,9 +501,18 @@ namespace ImFlow
         if (!m_filter(other, this)) // Check Filter
             return;
 
-        m_link = std::make_shared<Link>(other, this, (*m_inf));
+        // Same-node connections were explicitly allowed above, they are kept as cyclic links
+        bool delayed = other->isDelay();
+        bool ordered = delayed || (*m_inf)->orderLink(other, this);
+        if (!ordered && !(*m_inf)->cyclesAllowed() && m_parent != other->getParent())
+            return;
+
+        // Replacing the previous link is one edit
+        (*m_inf)->beginEdit();
+        m_link = std::allocate_shared<Link>(TaggedAllocator<Link, AllocTag_Links>{}, other, this, (*m_inf), !ordered, delayed);
         other->setLink(m_link);
         (*m_inf)->addLink(m_link);
+        (*m_inf)->endEdit();
     }
 
     // -----------------------------------------------------------------------------------------------------------------
@@ -326,16 +521,236 @@ namespace ImFlow
     template<class T>
     const T &OutPin<T>::val() noexcept(true)
     {
-        std::string s = std::to_string(m_uid) + std::to_string(m_parent->getUID());
-        if (std::find((*m_inf)->get_recursion_blacklist().begin(), (*m_inf)->get_recursion_blacklist().end(), s) == (*m_inf)->get_recursion_blacklist().end())
+        // While the evaluator thread runs, update() only reads the published values
+        if ((*m_inf)->readsSnapshot()) {
+            if constexpr (std::is_copy_assignable_v<T>)
+                if (m_snapshot)
+                    return (*m_snapshot)[(*m_inf)->getSnapshotSlot()];
+            assert(std::is_copy_assignable_v<T> && "Outputs that can't be copied aren't published by the evaluator");
+            return m_val;
+        }
+
+        if (m_next || !m_parent->isLive())
+            return m_val;
+
+        if (m_async)
         {
-            (*m_inf)->get_recursion_blacklist().emplace_back(s);
-            m_val = m_behaviour();
+            pollAsync();
+            return m_val;
+        }
+
+        // Stamping before the call also guards against re-entering through a cyclic link
+        uint64_t frame = (*m_inf)->getEvalFrame();
+        if (m_evalFrame != frame)
+        {
+            m_evalFrame = frame;
+            m_val = compute();
         }
 
         return m_val;
     }
 
+    template<class T>
+    T OutPin<T>::compute() noexcept(true)
+    {
+        // Cached values are handed out as copies: move-only outputs are never memoized
+        if constexpr (!std::is_copy_constructible_v<T>)
+            return run();
+        else
+        {
+            if (!m_memo)
+                return run();
+
+            std::size_t key = 0;
+            if (!m_parent->hashIns(key))
+            {
+                m_memo->misses++;
+                return run();
+            }
+            if (const T* hit = m_memo->find(key, [this](const HeldValues& ins) { return m_parent->matchIns(ins); }))
+            {
+                m_memo->hits++;
+                return *hit;
+            }
+            m_memo->misses++;
+            T v = run();
+            HeldValues ins;
+            if (m_parent->holdIns(ins))
+                m_memo->insert(key, std::move(ins), v);
+            return v;
+        }
+    }
+
+    template<class T>
+    T OutPin<T>::run() noexcept(true)
+    {
+        IMFLOW_TRACE_SCOPE(m_parent->getName());
+        if (!(*m_inf)->isProfiling())
+            return m_behaviour();
+
+        ProfileScope scope((*m_inf)->profileChildren());
+        T v = m_behaviour();
+        uint64_t self = scope.stop();
+        m_stats.add(self);
+        m_parent->getEvalStats().add(self);
+        return v;
+    }
+
+    template<class T>
+    void OutPin<T>::pollAsync() noexcept(true)
+    {
+        uint64_t frame = (*m_inf)->getEvalFrame();
+        if (m_evalFrame == frame)
+            return;
+        m_evalFrame = frame;
+
+        AsyncState<T>& a = *m_async;
+        if (a.job && a.job->done.load(std::memory_order_acquire))
+        {
+            if (a.job->result)
+            {
+                m_val = std::move(*a.job->result);
+                a.completed = true;
+            }
+            a.job.reset();
+        }
+        if (a.task && a.task->done())
+        {
+            m_val = a.task->take();
+            a.completed = true;
+            a.task.reset();
+        }
+
+        // Same hash: the copies of the inputs tell a collision apart
+        std::size_t key = 0;
+        bool keyed = m_parent->hashIns(key);
+        if (a.launched && !a.dirty && (!keyed || (key == a.key && (!a.held || m_parent->matchIns(a.ins)))))
+            return;
+        a.key = key;
+        a.ins.clear();
+        a.held = keyed && m_parent->holdIns(a.ins);
+        a.launched = true;
+        a.dirty = false;
+
+        if (a.taskLauncher)
+        {
+            // Replacing the Task destroys the stale coroutine
+            a.task.emplace(a.taskLauncher());
+            a.task->start((*m_inf)->getScheduler());
+            if (a.task->done())
+            {
+                m_val = a.task->take();
+                a.completed = true;
+                a.task.reset();
+            }
+            return;
+        }
+
+        // Stale job: ask it to stop, its result will never be read
+        if (a.job)
+            a.job->stop.request_stop();
+
+        auto job = std::allocate_shared<typename AsyncState<T>::Job>(TaggedAllocator<typename AsyncState<T>::Job, AllocTag_Evaluation>{});
+        (*m_inf)->getExecutor().submit([job, run = a.launcher()]()
+        {
+            if (!job->stop.stop_requested())
+            {
+                T r = run(job->stop.get_token());
+                if (!job->stop.stop_requested())
+                    job->result.emplace(std::move(r));
+            }
+            job->done.store(true, std::memory_order_release);
+        });
+        a.job = std::move(job);
+    }
+
+    template<class T>
+    void OutPin<T>::resolve() noexcept(true)
+    {
+        if (!m_next)
+        {
+            val();
+            return;
+        }
+
+        uint64_t frame = (*m_inf)->getEvalFrame();
+        if (m_evalFrame != frame)
+        {
+            m_evalFrame = frame;
+            *m_next = compute();
+        }
+    }
+
+    template<class T>
+    void OutPin<T>::commit() noexcept(true)
+    {
+        // Only what resolve() computed in this pass is moved out: move-only outputs build as well
+        if (!m_next || m_evalFrame != (*m_inf)->getEvalFrame())
+            return;
+        m_val = std::move(*m_next);
+    }
+
+    template<class T>
+    void OutPin<T>::fillColumn(std::byte* dst, std::size_t count) noexcept(true)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+            std::uninitialized_fill_n(reinterpret_cast<T*>(dst), count, m_val);
+    }
+
+    template<class T>
+    void OutPin<T>::memoryUsage(MemoryWalk& walk) const
+    {
+        countMemory(walk, sizeof(*this));
+        walk.stats.pins -= sizeof(m_behaviour) + sizeof(m_stagedBehaviour);
+        walk.stats.functions += sizeof(m_behaviour) + sizeof(m_stagedBehaviour);
+        walk.stats.graph += vector_bytes(m_links);
+
+        MemoryStats& s = walk.stats;
+        if (m_next)
+            s.evaluation += sizeof(T);
+        if (m_memo)
+        {
+            s.evaluation += sizeof(MemoCache<T>) + vector_bytes(m_memo->entries);
+            for (auto& e : m_memo->entries) { s.evaluation += vector_bytes(e.ins); }
+        }
+        if (m_snapshot)
+            s.evaluation += sizeof(std::array<T, 3>);
+        if (m_async)
+        {
+            s.evaluation += sizeof(AsyncState<T>) + vector_bytes(m_async->ins);
+            if (m_async->job)
+                s.evaluation += sizeof(typename AsyncState<T>::Job) + shared_block_bytes();
+        }
+    }
+
+    template<class T>
+    void OutPin<T>::push(const T& item)
+    {
+        for (auto &l: m_links) {
+            auto link = l.lock();
+            if (link && link->right()->getDataType() == typeid(T))
+                static_cast<InPin<T>*>(link->right())->receive(item);
+        }
+    }
+
+    template<class T>
+    void OutPin<T>::publish(uint8_t slot) noexcept(true)
+    {
+        if constexpr (std::is_copy_assignable_v<T>)
+            if (m_snapshot)
+                (*m_snapshot)[slot] = m_val;
+    }
+
+    template<class T>
+    void OutPin<T>::seedSnapshot()
+    {
+        if constexpr (std::is_copy_assignable_v<T>) {
+            if (!m_snapshot)
+                m_snapshot = make_tagged<std::array<T, 3>, AllocTag_Evaluation>();
+            m_snapshot->fill(m_val);
+        }
+    }
+
     template<class T>
     void OutPin<T>::createLink(ImFlow::Pin *other) noexcept(true)
     {
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <new>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+namespace ImFlow
+{
+    /**
+     * @brief Subsystem an allocation of the library is accounted to
+     */
+    enum AllocTag
+    {
+        AllocTag_Nodes,      // Nodes created by the handler
+        AllocTag_Pins,       // Static and dynamic pins
+        AllocTag_Links,      // Links between pins
+        AllocTag_Graph,      // Topological order bookkeeping
+        AllocTag_Evaluation, // Evaluation state: plans, delays, snapshots, caches, streams, jobs and coroutine frames
+        AllocTag_Commands,   // Posted mutations
+        AllocTag_COUNT
+    };
+
+    /**
+     * @brief Hook receiving the allocations of the library
+     * @details Install it with set_allocator(), at any time: each block records the allocator that provided it and is returned
+     *          to it, whatever is installed when it's freed. An allocator must therefore outlive the blocks it provided.
+     *          Blocks are requested with room for that record in front (at least 16 bytes, see tagged_alloc()).
+     */
+    class Allocator
+    {
+    public:
+        virtual ~Allocator() = default;
+
+        /**
+         * @brief <BR>Allocate memory
+         * @param bytes Size of the block
+         * @param align Alignment of the block
+         * @param tag Subsystem requesting it
+         * @return Pointer to the block. Must not be null
+         */
+        virtual void* allocate(std::size_t bytes, std::size_t align, AllocTag tag) = 0;
+
+        /**
+         * @brief <BR>Release memory
+         * @param p Block returned by allocate()
+         * @param bytes Size it was allocated with
+         * @param align Alignment it was allocated with
+         * @param tag Subsystem it was allocated for
+         */
+        virtual void deallocate(void* p, std::size_t bytes, std::size_t align, AllocTag tag) noexcept = 0;
+    };
+
+    /**
+     * @brief Number and size of allocations, per subsystem
+     */
+    struct AllocStats
+    {
+        std::array<uint64_t, AllocTag_COUNT> count{};
+        std::array<uint64_t, AllocTag_COUNT> bytes{};
+
+        [[nodiscard]] constexpr uint64_t totalCount() const noexcept(true)
+        { uint64_t n = 0; for (auto c: count) { n += c; } return n; }
+
+        [[nodiscard]] constexpr uint64_t totalBytes() const noexcept(true)
+        { uint64_t n = 0; for (auto b: bytes) { n += b; } return n; }
+
+        constexpr AllocStats operator-(const AllocStats& o) const noexcept(true)
+        {
+            AllocStats d;
+            for (std::size_t i = 0; i < AllocTag_COUNT; i++) {
+                d.count[i] = count[i] - o.count[i];
+                d.bytes[i] = bytes[i] - o.bytes[i];
+            }
+            return d;
+        }
+    };
+
+    /**
+     * @brief Process-wide state of the allocation hook
+     */
+    struct AllocHook
+    {
+        std::atomic<Allocator*>                          allocator = nullptr;
+        std::array<std::atomic<uint64_t>, AllocTag_COUNT> count{};
+        std::array<std::atomic<uint64_t>, AllocTag_COUNT> bytes{};
+    };
+
+    /**
+     * @brief <BR>Get the allocation hook
+     * @return Reference to the process-wide hook
+     */
+    inline AllocHook& alloc_hook() noexcept(true)
+    {
+        static AllocHook hook;
+        return hook;
+    }
+
+    /**
+     * @brief <BR>Get the allocation counters of the calling thread
+     * @return Reference to the counters, only updated by this thread
+     */
+    inline AllocStats& alloc_thread_stats() noexcept(true)
+    {
+        thread_local AllocStats stats;
+        return stats;
+    }
+
+    /**
+     * @brief <BR>Route the allocations of the library
+     * @param allocator Allocator to use, nullptr restores the global operator new
+     */
+    inline void set_allocator(Allocator* allocator) noexcept(true)
+    {
+        alloc_hook().allocator.store(allocator, std::memory_order_release);
+    }
+
+    /**
+     * @brief <BR>Read the allocation counters
+     * @return Allocations made by the library since the start of the program
+     */
+    inline AllocStats allocation_stats() noexcept(true)
+    {
+        AllocHook& h = alloc_hook();
+        AllocStats s;
+        for (std::size_t i = 0; i < AllocTag_COUNT; i++) {
+            s.count[i] = h.count[i].load(std::memory_order_relaxed);
+            s.bytes[i] = h.bytes[i].load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+
+    /**
+     * @brief <BR>Read the allocation counters of the calling thread
+     * @details Unlike allocation_stats(), the evaluator, the executor and the other threads allocating meanwhile are not included.
+     * @return Allocations made by the library on this thread since it started
+     */
+    inline AllocStats thread_allocation_stats() noexcept(true)
+    { return alloc_thread_stats(); }
+
+    /**
+     * @brief <BR>Get the size of the record in front of a block
+     * @details Keeps the block aligned, and holds the allocator that provided it.
+     * @param align Alignment of the block
+     * @return Number of bytes
+     */
+    constexpr std::size_t tagged_header(std::size_t align) noexcept(true)
+    { return align > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? align : __STDCPP_DEFAULT_NEW_ALIGNMENT__; }
+
+    /**
+     * @brief <BR>Allocate memory for the library, counting it
+     * @details The installed allocator, or the global operator new, is asked for bytes + tagged_header(align).
+     * @param bytes Size of the block
+     * @param align Alignment of the block
+     * @param tag Subsystem requesting it
+     * @return Pointer to the block
+     */
+    inline void* tagged_alloc(std::size_t bytes, std::size_t align, AllocTag tag)
+    {
+        AllocHook& h = alloc_hook();
+        h.count[tag].fetch_add(1, std::memory_order_relaxed);
+        h.bytes[tag].fetch_add(bytes, std::memory_order_relaxed);
+        AllocStats& t = alloc_thread_stats();
+        t.count[tag]++;
+        t.bytes[tag] += bytes;
+
+        std::size_t header = tagged_header(align);
+        Allocator* a = h.allocator.load(std::memory_order_acquire);
+        void* raw;
+        if (a)
+            raw = a->allocate(bytes + header, align, tag);
+        else if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            raw = ::operator new(bytes + header, std::align_val_t(align));
+        else
+            raw = ::operator new(bytes + header);
+        std::byte* p = static_cast<std::byte*>(raw) + header;
+        std::memcpy(p - sizeof(Allocator*), &a, sizeof(Allocator*));
+        return p;
+    }
+
+    /**
+     * @brief <BR>Release memory obtained with tagged_alloc()
+     * @details Returned to the allocator that provided it, even if another one is installed now.
+     * @param p Block to release
+     * @param bytes Size it was allocated with
+     * @param align Alignment it was allocated with
+     * @param tag Subsystem it was allocated for
+     */
+    inline void tagged_free(void* p, std::size_t bytes, std::size_t align, AllocTag tag) noexcept(true)
+    {
+        std::size_t header = tagged_header(align);
+        Allocator* a;
+        std::memcpy(&a, static_cast<std::byte*>(p) - sizeof(Allocator*), sizeof(Allocator*));
+        void* raw = static_cast<std::byte*>(p) - header;
+        if (a)
+            a->deallocate(raw, bytes + header, align, tag);
+        else if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(raw, bytes + header, std::align_val_t(align));
+        else
+            ::operator delete(raw, bytes + header);
+    }
+
+    /**
+     * @brief Standard allocator routed through tagged_alloc()
+     * @details For containers and std::allocate_shared.
+     * @tparam T Type of the elements
+     * @tparam Tag Subsystem the allocations are accounted to
+     */
+    template<class T, AllocTag Tag> class TaggedAllocator
+    {
+    public:
+        using value_type = T;
+
+        template<class U> struct rebind { using other = TaggedAllocator<U, Tag>; };
+
+        constexpr TaggedAllocator() noexcept(true) = default;
+        template<class U> constexpr TaggedAllocator(const TaggedAllocator<U, Tag>&) noexcept(true) {}
+
+        T* allocate(std::size_t n)
+        { return static_cast<T*>(tagged_alloc(n * sizeof(T), alignof(T), Tag)); }
+
+        void deallocate(T* p, std::size_t n) noexcept(true)
+        { tagged_free(p, n * sizeof(T), alignof(T), Tag); }
+
+        template<class U> constexpr bool operator==(const TaggedAllocator<U, Tag>&) const noexcept(true) { return true; }
+    };
+
+    /**
+     * @brief <BR>Construct an object in memory obtained with tagged_alloc()
+     * @tparam T Type of the object
+     * @tparam Tag Subsystem the allocation is accounted to
+     * @param args Arguments forwarded to the constructor
+     * @return Pointer to the object, to release with tagged_delete()
+     */
+    template<class T, AllocTag Tag, class... Args> T* tagged_new(Args&&... args)
+    {
+        void* p = tagged_alloc(sizeof(T), alignof(T), Tag);
+        try
+        {
+            return ::new (p) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            tagged_free(p, sizeof(T), alignof(T), Tag);
+            throw;
+        }
+    }
+
+    /**
+     * @brief <BR>Destroy an object created with tagged_new()
+     * @tparam Tag Subsystem it was allocated for
+     * @param p Pointer to the object. Ignored if null
+     */
+    template<AllocTag Tag, class T> void tagged_delete(T* p) noexcept(true)
+    {
+        if (!p)
+            return;
+        p->~T();
+        tagged_free(p, sizeof(T), alignof(T), Tag);
+    }
+
+    /**
+     * @brief Deleter of std::unique_ptr for the objects created with tagged_new()
+     */
+    template<class T, AllocTag Tag> struct TaggedDelete
+    {
+        void operator()(T* p) const noexcept(true) { tagged_delete<Tag>(p); }
+    };
+
+    /**
+     * @brief Owning pointer to an object allocated through the hook
+     */
+    template<class T, AllocTag Tag> using TaggedPtr = std::unique_ptr<T, TaggedDelete<T, Tag>>;
+
+    /**
+     * @brief <BR>Create an object owned by a TaggedPtr, like std::make_unique()
+     * @tparam T Type of the object
+     * @tparam Tag Subsystem the allocation is accounted to
+     * @param args Arguments forwarded to the constructor
+     * @return Owning pointer to the object
+     */
+    template<class T, AllocTag Tag, class... Args> TaggedPtr<T, Tag> make_tagged(Args&&... args)
+    { return TaggedPtr<T, Tag>(tagged_new<T, Tag>(std::forward<Args>(args)...)); }
+}
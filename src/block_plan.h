@@ -0,0 +1,92 @@
+#pragma once
+
+#include <span>
+#include <memory>
+#include <vector>
+#include <functional>
+#include "allocator.h"
+
+namespace ImFlow
+{
+    class BaseNode;
+
+    /**
+     * @brief Type of the samples carried by block-processing links
+     */
+    using Sample = float;
+
+    /**
+     * @brief Buffers handed to a node's block processing logic
+     * @details Inputs and outputs are numbered in declaration order, counting only the pins of type Sample.
+     */
+    class BlockIO
+    {
+    public:
+        /**
+         * @brief <BR>Get an input buffer
+         * @param i Index of the input
+         * @return Samples of the current block
+         */
+        [[nodiscard]] std::span<const Sample> in(std::size_t i) const noexcept(true)
+        { return m_ins[i]; }
+
+        /**
+         * @brief <BR>Get an output buffer
+         * @param i Index of the output
+         * @return Samples of the current block, to be written
+         */
+        [[nodiscard]] std::span<Sample> out(std::size_t i) const noexcept(true)
+        { return m_outs[i]; }
+
+        /**
+         * @brief <BR>Get number of inputs
+         * @return Number of input buffers
+         */
+        [[nodiscard]] std::size_t insCount() const noexcept(true)
+        { return m_ins.size(); }
+
+        /**
+         * @brief <BR>Get number of outputs
+         * @return Number of output buffers
+         */
+        [[nodiscard]] std::size_t outsCount() const noexcept(true)
+        { return m_outs.size(); }
+
+        /**
+         * @brief <BR>Get block size
+         * @return Number of samples in each buffer
+         */
+        [[nodiscard]] std::size_t size() const noexcept(true)
+        { return m_size; }
+
+    private:
+        friend class ImNodeFlow;
+
+        std::span<const std::span<const Sample>> m_ins;
+        std::span<const std::span<Sample>>       m_outs;
+        std::size_t                              m_size = 0;
+    };
+
+    /**
+     * @brief Block processing schedule compiled from the graph
+     * @details Built on the UI thread and handed over to the processing thread whole, which then only reads it.
+     *          Every buffer is allocated up front in a single pool. The plan keeps its nodes alive until it is retired.
+     */
+    struct BlockPlan
+    {
+        struct Step
+        {
+            std::shared_ptr<BaseNode>             node;
+            std::function<void(const BlockIO&)>   process;
+            BlockIO                               io;
+        };
+
+        template<class T> using List = std::vector<T, TaggedAllocator<T, AllocTag_Evaluation>>;
+
+        std::size_t                   blockSize = 0;
+        List<Sample>                  pool;
+        List<std::span<const Sample>> ins;
+        List<std::span<Sample>>       outs;
+        List<Step>                    steps;
+    };
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <exception>
+#include <type_traits>
+#include "allocator.h"
+
+namespace ImFlow
+{
+    class ImNodeFlow;
+
+    /**
+     * @brief Graph mutation waiting in the CommandQueue
+     */
+    struct Command
+    {
+        virtual ~Command() = default;
+
+        /**
+         * @brief <BR>Apply the mutation
+         * @param inf Handler the command was posted to
+         */
+        virtual void run([[maybe_unused]] ImNodeFlow& inf) noexcept(true) {}
+
+        // Commands are accounted to their own subsystem, whatever their size
+        static void* operator new(std::size_t bytes)
+        { return tagged_alloc(bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__, AllocTag_Commands); }
+        static void operator delete(void* p, std::size_t bytes) noexcept(true)
+        { tagged_free(p, bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__, AllocTag_Commands); }
+
+        std::atomic<Command*> next = nullptr;
+    };
+
+    /**
+     * @brief Command carrying a function and the promise of its result
+     * @tparam F Type of the function, called with the handler
+     */
+    template<class F> struct PostedCommand : Command
+    {
+        using Result = std::invoke_result_t<F&, ImNodeFlow&>;
+
+        explicit PostedCommand(F fn) : fn(std::move(fn)) {}
+
+        void run(ImNodeFlow& inf) noexcept(true) override
+        {
+            try
+            {
+                if constexpr (std::is_void_v<Result>)
+                {
+                    fn(inf);
+                    promise.set_value();
+                }
+                else
+                    promise.set_value(fn(inf));
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+        }
+
+        F                    fn;
+        std::promise<Result> promise;
+    };
+
+    /**
+     * @brief Lock-free multiple producers, single consumer queue of commands
+     * @details Intrusive queue (D. Vyukov): pushing is one atomic exchange and never blocks nor fails.
+     *          Only the handler pops, on the UI thread. A command whose push is still in progress stops the drain:
+     *          it is picked up by the next one.
+     */
+    class CommandQueue
+    {
+    public:
+        CommandQueue() = default;
+        CommandQueue(const CommandQueue&) = delete;
+        CommandQueue& operator=(const CommandQueue&) = delete;
+        /***/
+        ~CommandQueue() { clear(); }
+
+        /**
+         * @brief <BR>Queue a command. Thread-safe
+         * @param c Command allocated with new. The queue takes its ownership
+         */
+        void push(Command* c) noexcept(true)
+        {
+            c->next.store(nullptr, std::memory_order_relaxed);
+            Command* prev = m_head.exchange(c, std::memory_order_acq_rel);
+            prev->next.store(c, std::memory_order_release);
+        }
+
+        /**
+         * @brief <BR>Take the oldest command. Consumer only
+         * @return Command to be run and deleted by the caller, or nullptr
+         */
+        [[nodiscard]] Command* pop() noexcept(true)
+        {
+            Command* tail = m_tail;
+            Command* next = tail->next.load(std::memory_order_acquire);
+            if (tail == &m_stub)
+            {
+                if (!next)
+                    return nullptr;
+                m_tail = next;
+                tail = next;
+                next = next->next.load(std::memory_order_acquire);
+            }
+            if (next)
+            {
+                m_tail = next;
+                return tail;
+            }
+            if (tail != m_head.load(std::memory_order_acquire))
+                return nullptr;
+            push(&m_stub);
+            next = tail->next.load(std::memory_order_acquire);
+            if (next)
+            {
+                m_tail = next;
+                return tail;
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief <BR>Run every available command, in posting order. Consumer only
+         * @param inf Handler passed to the commands
+         */
+        void drain(ImNodeFlow& inf) noexcept(true)
+        {
+            while (Command* c = pop())
+            {
+                c->run(inf);
+                delete c;
+            }
+        }
+
+        /**
+         * @brief <BR>Drop every available command without running it. Consumer only
+         * @details Their futures report a broken promise.
+         */
+        void clear() noexcept(true)
+        {
+            while (Command* c = pop())
+                delete c;
+        }
+
+    private:
+        Command                m_stub;
+        std::atomic<Command*>  m_head = &m_stub;
+        Command*               m_tail = &m_stub;
+    };
+}
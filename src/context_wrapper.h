@@ -2,6 +2,7 @@
 
 #include <imgui.h>
 #include <imgui_internal.h>
+#include "trace.h"
 
 inline static void CopyIOEvents(ImGuiContext* src, ImGuiContext* dst, ImVec2 origin, float scale)
 {
@@ -149,7 +150,10 @@ inline void ContainedContext::begin()
     ImGui::GetIO().ConfigFlags &= ~(ImGuiConfigFlags_ViewportsEnable | ImGuiConfigFlags_DockingEnable);
 #endif
     
-    ImGui::NewFrame();
+    {
+        IMFLOW_TRACE_SCOPE("NewFrame");
+        ImGui::NewFrame();
+    }
 
     if (!m_config.extra_window_wrapper)
         return;
@@ -183,6 +187,7 @@ inline void ContainedContext::end()
     if (m_config.extra_window_wrapper)
         ImGui::End();
 
+    IMFLOW_TRACE_PHASES(phase, "Render");
     ImGui::Render();
 
     ImDrawData* draw_data = ImGui::GetDrawData();
@@ -190,9 +195,12 @@ inline void ContainedContext::end()
     ImGui::SetCurrentContext(m_original_ctx);
     m_original_ctx = nullptr;
 
+    IMFLOW_TRACE_NEXT(phase, "AppendDrawData");
     for (int i = 0; i < draw_data->CmdListsCount; ++i)
         AppendDrawData(draw_data->CmdLists[i], m_origin, m_scale);
 
+    IMFLOW_TRACE_NEXT(phase, "Zoom and scroll");
+
     m_hovered = ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows) && !m_anyWindowHovered;
 
     // Zooming
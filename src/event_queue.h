@@ -0,0 +1,263 @@
+#pragma once
+
+#include <bit>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "allocator.h"
+
+namespace ImFlow
+{
+    /**
+     * @brief What an event stream does with an item pushed while its queue is full
+     */
+    enum StreamPolicy
+    {
+        StreamPolicy_Block,      // Wait for the consumer to make room. The consumer must drain from another thread
+        StreamPolicy_DropOldest, // Discard the oldest queued item
+        StreamPolicy_Coalesce    // Keep the item aside, replacing the previous overflowing one. Later items replace it until it's drained
+    };
+
+    /**
+     * @brief Bounded lock-free multiple producers, multiple consumers queue of events
+     * @details Ring of cells tagged with sequence numbers (D. Vyukov): producers and consumers each claim a cell with
+     *          a single compare-and-swap. Only the coalescing slot, used when the ring is full, is guarded by a spinlock.
+     * @tparam T Type of the items
+     */
+    template<class T> class EventQueue
+    {
+    public:
+        /**
+         * @brief <BR>Allocate the ring
+         * @param capacity Maximum number of queued items. Rounded up to a power of two
+         * @param policy Behaviour when full
+         */
+        EventQueue(std::size_t capacity, StreamPolicy policy)
+          : m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1), m_policy(policy),
+            m_cells(m_mask + 1)
+        {
+            for (std::size_t i = 0; i <= m_mask; i++)
+                m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+
+        EventQueue(const EventQueue&) = delete;
+        EventQueue& operator=(const EventQueue&) = delete;
+
+        /**
+         * @brief <BR>Queue an item, applying the policy if full
+         * @details Items of one producer are drained in push order: with StreamPolicy_Coalesce, nothing enters the ring
+         *          while an item is set aside, so that no later item overtakes it.
+         * @param item Item to queue
+         */
+        void push(T item)
+        {
+            if (m_policy == StreamPolicy_Coalesce && m_hasOverflow.load(std::memory_order_acquire))
+            {
+                coalesce(item);
+                return;
+            }
+            if (tryPush(item))
+                return;
+            switch (m_policy)
+            {
+                case StreamPolicy_Block:
+                    while (!tryPush(item))
+                        std::this_thread::yield();
+                    break;
+                case StreamPolicy_DropOldest:
+                    while (!tryPush(item))
+                    {
+                        T old;
+                        if (tryPop(old))
+                            m_drops.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    break;
+                case StreamPolicy_Coalesce:
+                    coalesce(item);
+                    break;
+            }
+        }
+
+        /**
+         * @brief <BR>Queue an item if there is room
+         * @param item Item to queue. Only moved from on success
+         * @return [FALSE] if the queue is full
+         */
+        bool tryPush(T& item)
+        {
+            std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell& c = m_cells[pos & m_mask];
+                std::size_t seq = c.seq.load(std::memory_order_acquire);
+                auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        c.value = std::move(item);
+                        c.seq.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief <BR>Take the oldest item
+         * @param out Receives the item
+         * @return [FALSE] if the ring is empty
+         */
+        bool tryPop(T& out)
+        {
+            std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell& c = m_cells[pos & m_mask];
+                std::size_t seq = c.seq.load(std::memory_order_acquire);
+                auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+                if (diff == 0)
+                {
+                    if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        out = std::move(c.value);
+                        c.seq.store(pos + m_mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief <BR>Consume queued items in a batch
+         * @details The coalesced item, if any, comes once the ring is empty: it's newer than every item in the ring.
+         * @param fn Function or lambda expression called with each item
+         * @param max Maximum number of items to consume
+         * @return Number of items consumed
+         */
+        template<class F> std::size_t drain(F&& fn, std::size_t max)
+        {
+            std::size_t n = 0;
+            T item;
+            while (n < max)
+            {
+                if (!tryPop(item))
+                {
+                    if (!m_hasOverflow.load(std::memory_order_acquire))
+                        break;
+                    lockOverflow();
+                    // The ring may have filled up again before the item was set aside: those items come first
+                    bool older = tryPop(item);
+                    std::optional<T> last;
+                    if (!older)
+                    {
+                        last = std::move(m_overflow);
+                        m_overflow.reset();
+                        m_hasOverflow.store(false, std::memory_order_relaxed);
+                    }
+                    m_overflowLock.clear(std::memory_order_release);
+                    if (!older)
+                    {
+                        if (!last)
+                            break;
+                        item = std::move(*last);
+                    }
+                }
+                fn(std::move(item));
+                n++;
+            }
+            return n;
+        }
+
+        /**
+         * @brief <BR>Get queue depth
+         * @return Approximate number of queued items
+         */
+        [[nodiscard]] std::size_t depth() const noexcept(true)
+        {
+            std::size_t in = m_enqueuePos.load(std::memory_order_relaxed);
+            std::size_t out = m_dequeuePos.load(std::memory_order_relaxed);
+            return (in > out ? in - out : 0) + (m_hasOverflow.load(std::memory_order_relaxed) ? 1 : 0);
+        }
+
+        /**
+         * @brief <BR>Get capacity
+         * @return Maximum number of items in the ring
+         */
+        [[nodiscard]] std::size_t capacity() const noexcept(true)
+        { return m_mask + 1; }
+
+        /**
+         * @brief <BR>Get memory footprint
+         * @return Bytes of the queue and of its ring
+         */
+        [[nodiscard]] std::size_t footprint() const noexcept(true)
+        { return sizeof(*this) + capacity() * sizeof(Cell); }
+
+        /**
+         * @brief <BR>Get drop counter
+         * @return Number of items discarded by the policy so far
+         */
+        [[nodiscard]] uint64_t drops() const noexcept(true)
+        { return m_drops.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief <BR>Get policy
+         * @return Behaviour when full
+         */
+        [[nodiscard]] StreamPolicy policy() const noexcept(true)
+        { return m_policy; }
+
+    private:
+        struct Cell
+        {
+            std::atomic<std::size_t> seq;
+            T                        value{};
+        };
+
+        void lockOverflow() noexcept(true)
+        {
+            while (m_overflowLock.test_and_set(std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+
+        void coalesce(T& item)
+        {
+            lockOverflow();
+            // Drained since the ring was found full or the item set aside: the ring comes first again
+            if (m_hasOverflow.load(std::memory_order_relaxed) || !tryPush(item))
+            {
+                if (m_overflow)
+                    m_drops.fetch_add(1, std::memory_order_relaxed);
+                m_overflow = std::move(item);
+                m_hasOverflow.store(true, std::memory_order_relaxed);
+            }
+            m_overflowLock.clear(std::memory_order_release);
+        }
+
+        const std::size_t                                        m_mask;
+        const StreamPolicy                                       m_policy;
+        std::vector<Cell, TaggedAllocator<Cell, AllocTag_Evaluation>> m_cells;
+
+        // Producers and consumers on separate cache lines
+        alignas(64) std::atomic<std::size_t> m_enqueuePos = 0;
+        alignas(64) std::atomic<std::size_t> m_dequeuePos = 0;
+
+        alignas(64) std::atomic<uint64_t> m_drops = 0;
+        std::atomic_flag                  m_overflowLock;
+        std::atomic<bool>                 m_hasOverflow = false;
+        std::optional<T>                  m_overflow;
+    };
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/**
+ * Binary graph file: a header followed by flat tables, addressed by offsets from the start of the file.
+ *
+ * BinaryHeader                      Counts and offsets of the tables
+ * BinaryNode[nodeCount]             Nodes in topological order, each one owning a range of the pin table
+ * BinaryPin[pinCount]               Inputs then outputs of each node
+ * BinaryLink[linkCount]             Links, as indices in the node table and pin UIDs
+ * char[]                            Strings (titles), not null-terminated
+ * std::byte[]                       Blobs (default values, node states), 8 bytes aligned
+ *
+ * Values are stored in the byte order of the host.
+ */
+
+namespace ImFlow
+{
+    struct BinaryHeader
+    {
+        char     magic[4] = { 'I', 'N', 'F', 'B' };
+        uint32_t version = 1;
+        uint32_t nodeCount = 0;
+        uint32_t pinCount = 0;
+        uint32_t linkCount = 0;
+        uint32_t reserved = 0;
+        uint64_t nodes = 0;
+        uint64_t pins = 0;
+        uint64_t links = 0;
+        uint64_t strings = 0;
+        uint64_t blobs = 0;
+        uint64_t size = 0;
+    };
+
+    struct BinaryNode
+    {
+        uint64_t uid;
+        uint32_t type;
+        float    x, y;
+        uint32_t title, titleSize;  // Range of the string table
+        uint32_t firstPin, pinCount;
+        uint32_t state, stateSize;  // Range of the blobs
+        uint32_t reserved;
+    };
+
+    struct BinaryPin
+    {
+        uint64_t uid;
+        uint32_t value, valueSize;  // Range of the blobs
+        uint32_t kind;              // PinType
+        uint32_t reserved;
+    };
+
+    struct BinaryLink
+    {
+        uint64_t leftPin, rightPin;
+        uint32_t leftNode, rightNode;
+    };
+
+    static_assert(sizeof(BinaryHeader) == 72 && sizeof(BinaryNode) == 48 && sizeof(BinaryPin) == 24 && sizeof(BinaryLink) == 24,
+                  "Binary graph records must have a fixed layout");
+
+    /**
+     * @brief Read-only view of a binary graph file, checked against its size
+     * @details Records are copied out on access: the file doesn't need to be aligned.
+     */
+    class BinaryGraphView
+    {
+    public:
+        /**
+         * @brief <BR>Check the header and the bounds of the tables
+         * @param bytes Content of the file
+         */
+        explicit BinaryGraphView(std::span<const std::byte> bytes) noexcept(true)
+          : m_bytes(bytes)
+        {
+            if (bytes.size() < sizeof(BinaryHeader))
+                return;
+            std::memcpy(&m_header, bytes.data(), sizeof(BinaryHeader));
+            const BinaryHeader h;
+            m_valid = std::memcmp(m_header.magic, h.magic, sizeof(h.magic)) == 0 && m_header.version == h.version &&
+                      m_header.size == bytes.size() &&
+                      fits(m_header.nodes, uint64_t(m_header.nodeCount) * sizeof(BinaryNode)) &&
+                      fits(m_header.pins, uint64_t(m_header.pinCount) * sizeof(BinaryPin)) &&
+                      fits(m_header.links, uint64_t(m_header.linkCount) * sizeof(BinaryLink)) &&
+                      m_header.strings <= m_header.blobs && m_header.blobs <= m_header.size;
+        }
+
+        /**
+         * @brief <BR>Get validity
+         * @return [TRUE] if the header is recognized and the tables are within the file
+         */
+        [[nodiscard]] constexpr bool valid() const noexcept(true) { return m_valid; }
+
+        [[nodiscard]] constexpr const BinaryHeader& header() const noexcept(true) { return m_header; }
+
+        [[nodiscard]] BinaryNode node(uint32_t i) const noexcept(true) { return read<BinaryNode>(m_header.nodes, i); }
+        [[nodiscard]] BinaryPin pin(uint32_t i) const noexcept(true) { return read<BinaryPin>(m_header.pins, i); }
+        [[nodiscard]] BinaryLink link(uint32_t i) const noexcept(true) { return read<BinaryLink>(m_header.links, i); }
+
+        /**
+         * @brief <BR>Get a string of the string table
+         * @return The string, empty if out of bounds
+         */
+        [[nodiscard]] std::string_view string(uint32_t offset, uint32_t size) const noexcept(true)
+        {
+            if (uint64_t(offset) + size > m_header.blobs - m_header.strings)
+                return {};
+            return { reinterpret_cast<const char*>(m_bytes.data() + m_header.strings + offset), size };
+        }
+
+        /**
+         * @brief <BR>Get a blob
+         * @return The bytes, empty if out of bounds
+         */
+        [[nodiscard]] std::span<const std::byte> blob(uint32_t offset, uint32_t size) const noexcept(true)
+        {
+            if (uint64_t(offset) + size > m_header.size - m_header.blobs)
+                return {};
+            return m_bytes.subspan(m_header.blobs + offset, size);
+        }
+
+    private:
+        [[nodiscard]] bool fits(uint64_t offset, uint64_t bytes) const noexcept(true)
+        { return offset <= m_bytes.size() && bytes <= m_bytes.size() - offset; }
+
+        template<class R> [[nodiscard]] R read(uint64_t table, uint32_t i) const noexcept(true)
+        {
+            R r;
+            std::memcpy(&r, m_bytes.data() + table + uint64_t(i) * sizeof(R), sizeof(R));
+            return r;
+        }
+
+        std::span<const std::byte> m_bytes;
+        BinaryHeader               m_header;
+        bool                       m_valid = false;
+    };
+
+    /**
+     * @brief Read-only memory mapping of a whole file
+     */
+    class MappedFile
+    {
+    public:
+        /**
+         * @brief <BR>Map a file
+         * @param path Path of the file. Check isOpen() for failures
+         */
+        explicit MappedFile(const std::string& path) noexcept(true);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * @brief <BR>Get mapping status
+         * @return [TRUE] if the file is mapped. Empty files can't be mapped
+         */
+        [[nodiscard]] constexpr bool isOpen() const noexcept(true) { return m_data != nullptr; }
+
+        /**
+         * @brief <BR>Get the content of the file
+         * @return View of the mapped bytes
+         */
+        [[nodiscard]] constexpr std::span<const std::byte> bytes() const noexcept(true) { return { m_data, m_size }; }
+
+    private:
+        const std::byte* m_data = nullptr;
+        std::size_t      m_size = 0;
+#ifdef _WIN32
+        void*            m_file = nullptr;
+        void*            m_mapping = nullptr;
+#endif
+    };
+}
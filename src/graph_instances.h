@@ -0,0 +1,164 @@
+#pragma once
+
+#include <span>
+#include <memory>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <typeinfo>
+#include <functional>
+#include <unordered_map>
+
+namespace ImFlow
+{
+    class Pin;
+    class BaseNode;
+
+    /**
+     * @brief Values of one pin for every instance, stored contiguously
+     */
+    struct BatchColumn
+    {
+        std::byte*            data = nullptr;
+        const std::type_info* type = nullptr;
+    };
+
+    /**
+     * @brief Columns handed to a node's batch processing logic
+     * @details Inputs and outputs are numbered in declaration order.
+     *          Columns are 64 bytes aligned at the start of the graph instances, ready for SIMD loops.
+     */
+    class BatchIO
+    {
+    public:
+        /**
+         * @brief <BR>Get the values of an input
+         * @tparam T Data type of the input
+         * @param i Index of the input
+         * @return Values of the batch, one per instance
+         */
+        template<class T> [[nodiscard]] std::span<const T> in(std::size_t i) const noexcept(true)
+        {
+            assert(m_ins[i].type && *m_ins[i].type == typeid(T) && "Wrong column type!");
+            return {reinterpret_cast<const T*>(m_ins[i].data) + m_first, m_count};
+        }
+
+        /**
+         * @brief <BR>Get the values of an output
+         * @tparam T Data type of the output
+         * @param i Index of the output
+         * @return Values of the batch, one per instance, to be written
+         */
+        template<class T> [[nodiscard]] std::span<T> out(std::size_t i) const noexcept(true)
+        {
+            assert(m_outs[i].type && *m_outs[i].type == typeid(T) && "Wrong column type!");
+            return {reinterpret_cast<T*>(m_outs[i].data) + m_first, m_count};
+        }
+
+        /**
+         * @brief <BR>Get batch size
+         * @return Number of instances in the batch
+         */
+        [[nodiscard]] std::size_t size() const noexcept(true)
+        { return m_count; }
+
+        /**
+         * @brief <BR>Get index of the first instance
+         * @return Offset of the batch in the columns
+         */
+        [[nodiscard]] std::size_t first() const noexcept(true)
+        { return m_first; }
+
+    private:
+        friend class ImNodeFlow;
+        friend class GraphInstances;
+
+        std::span<const BatchColumn> m_ins;
+        std::span<const BatchColumn> m_outs;
+        std::size_t                  m_first = 0;
+        std::size_t                  m_count = 0;
+    };
+
+    /**
+     * @brief Many evaluations of one graph topology
+     * @details Created by ImNodeFlow::instantiate(). Every pin of the batch processors gets a column holding its value
+     *          for each instance, so an instance costs only its values. Connected inputs read the column of their output.
+     *          <BR> Independent from later changes of the graph, but keeps its batch processors alive.
+     */
+    class GraphInstances
+    {
+    public:
+        GraphInstances() = default;
+        GraphInstances(GraphInstances&&) noexcept(true) = default;
+        GraphInstances& operator=(GraphInstances&&) noexcept(true) = default;
+
+        /**
+         * @brief <BR>Get the values of a pin
+         * @details Write the inputs to set per-instance parameters, read the outputs after evaluate().
+         * @tparam T Data type of the pin
+         * @param pin Pin of a batch processor
+         * @return Values of every instance. Empty if the pin has no column of type T
+         */
+        template<class T> [[nodiscard]] std::span<T> column(Pin* pin) noexcept(true)
+        {
+            auto it = m_columns.find(pin);
+            if (it == m_columns.end() || !it->second.type || *it->second.type != typeid(T))
+                return {};
+            return {reinterpret_cast<T*>(it->second.data), m_count};
+        }
+
+        /**
+         * @brief <BR>Evaluate every instance
+         */
+        void evaluate() noexcept(true)
+        { evaluate(0, m_count); }
+
+        /**
+         * @brief <BR>Evaluate a range of instances
+         * @details Ranges that don't overlap can be evaluated concurrently.
+         * @param first Index of the first instance
+         * @param count Number of instances
+         */
+        void evaluate(std::size_t first, std::size_t count) noexcept(true)
+        {
+            for (auto &s: m_steps) {
+                BatchIO io = s.io;
+                io.m_first = first;
+                io.m_count = count;
+                s.process(io);
+            }
+        }
+
+        /**
+         * @brief <BR>Get number of instances
+         * @return Number of instances
+         */
+        [[nodiscard]] std::size_t size() const noexcept(true)
+        { return m_count; }
+
+        /**
+         * @brief <BR>Get memory cost of an instance
+         * @return Bytes of values stored per instance
+         */
+        [[nodiscard]] std::size_t bytesPerInstance() const noexcept(true)
+        { return m_bytesPerInstance; }
+
+    private:
+        friend class ImNodeFlow;
+
+        struct Step
+        {
+            std::shared_ptr<BaseNode>           node;
+            std::function<void(const BatchIO&)> process;
+            BatchIO                             io;
+        };
+
+        std::size_t                            m_count = 0;
+        std::size_t                            m_bytesPerInstance = 0;
+        std::unique_ptr<std::byte[]>           m_pool;
+        std::vector<BatchColumn>               m_ins;
+        std::vector<BatchColumn>               m_outs;
+        std::unordered_map<Pin*, BatchColumn>  m_columns;
+        std::vector<Step>                      m_steps;
+    };
+}
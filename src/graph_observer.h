@@ -0,0 +1,63 @@
+#pragma once
+
+#include <imgui.h>
+
+namespace ImFlow
+{
+    class Link;
+    class BaseNode;
+
+    /**
+     * @brief Receives the structural edits of a graph
+     * @details Register it with ImNodeFlow::addObserver(). Callbacks run on the thread editing the graph, while the edit happens:
+     *          they must not edit the graph themselves.
+     *          A removed node has lost its links (each one reported) by the time nodeRemoved() is called.
+     */
+    class GraphObserver
+    {
+    public:
+        virtual ~GraphObserver() = default;
+
+        /**
+         * @brief <BR>A node was added, its constructor has run
+         * @param node Reference to the node
+         */
+        virtual void nodeAdded([[maybe_unused]] BaseNode& node) {}
+
+        /**
+         * @brief <BR>A node is about to be removed
+         * @param node Reference to the node
+         */
+        virtual void nodeRemoved([[maybe_unused]] BaseNode& node) {}
+
+        /**
+         * @brief <BR>A node was dragged to a new position
+         * @param node Reference to the node, at its new position
+         * @param from Position before the drag, in grid coordinates
+         */
+        virtual void nodeMoved([[maybe_unused]] BaseNode& node, [[maybe_unused]] const ImVec2& from) {}
+
+        /**
+         * @brief <BR>A link was created
+         * @param link Reference to the link
+         */
+        virtual void linkAdded([[maybe_unused]] Link& link) {}
+
+        /**
+         * @brief <BR>A link is about to be destroyed
+         * @param link Reference to the link. Only its pins' UIDs and parents can be read
+         */
+        virtual void linkRemoved([[maybe_unused]] Link& link) {}
+
+        /**
+         * @brief <BR>Start of a group of edits forming one user action
+         * @details Groups nest: a frame of ImNodeFlow::update(), a file load, a link replacing another one, ...
+         */
+        virtual void editBegin() {}
+
+        /**
+         * @brief <BR>End of a group of edits
+         */
+        virtual void editEnd() {}
+    };
+}
@@ -0,0 +1,429 @@
+#include "ImNodeFlow.h"
+#include "graph_patch.h"
+#include "node_record.h"
+
+#include <cerrno>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ImFlow
+{
+    // Patch: [magic][u32 version][u32 count], then per record [u8 op][u32 size][payload]
+    static constexpr char     patch_magic[4] = { 'I', 'N', 'F', 'P' };
+    static constexpr uint32_t patch_version = 1;
+    static constexpr std::size_t patch_header = 12;
+
+    LinkKey LinkKey::of(const Link& link) noexcept(true)
+    {
+        return { static_cast<uint64_t>(link.left()->getParent()->getUID()), static_cast<uint64_t>(link.left()->getUid()),
+                 static_cast<uint64_t>(link.right()->getParent()->getUID()), static_cast<uint64_t>(link.right()->getUid()) };
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // PATCH
+
+    GraphPatch::GraphPatch()
+    {
+        m_bytes.resize(patch_header);
+        std::memcpy(m_bytes.data(), patch_magic, sizeof(patch_magic));
+        std::memcpy(m_bytes.data() + sizeof(patch_magic), &patch_version, sizeof(patch_version));
+    }
+
+    uint32_t GraphPatch::size() const noexcept(true)
+    {
+        uint32_t count = 0;
+        if (m_bytes.size() >= patch_header)
+            std::memcpy(&count, m_bytes.data() + 8, sizeof(count));
+        return count;
+    }
+
+    std::size_t GraphPatch::begin(PatchOp op)
+    {
+        record_put(m_bytes, op);
+        std::size_t at = m_bytes.size();
+        record_put(m_bytes, uint32_t(0));
+        return at;
+    }
+
+    void GraphPatch::end(std::size_t at)
+    {
+        auto size = static_cast<uint32_t>(m_bytes.size() - at - sizeof(uint32_t));
+        std::memcpy(m_bytes.data() + at, &size, sizeof(size));
+        uint32_t count = this->size() + 1;
+        std::memcpy(m_bytes.data() + 8, &count, sizeof(count));
+    }
+
+    void GraphPatch::addNode(const NodeRegistry& registry, BaseNode& node)
+    {
+        std::size_t at = begin(PatchOp_AddNode);
+        write_node_record(registry, node, m_bytes);
+        end(at);
+    }
+
+    void GraphPatch::setNode(const NodeRegistry& registry, BaseNode& node)
+    {
+        std::size_t at = begin(PatchOp_SetNode);
+        write_node_record(registry, node, m_bytes);
+        end(at);
+    }
+
+    void GraphPatch::removeNode(NodeUID uid)
+    {
+        std::size_t at = begin(PatchOp_RemoveNode);
+        record_put(m_bytes, static_cast<uint64_t>(uid));
+        end(at);
+    }
+
+    void GraphPatch::moveNode(NodeUID uid, const ImVec2& pos)
+    {
+        std::size_t at = begin(PatchOp_MoveNode);
+        record_put(m_bytes, static_cast<uint64_t>(uid));
+        record_put(m_bytes, pos);
+        end(at);
+    }
+
+    void GraphPatch::addLink(const LinkKey& link)
+    {
+        std::size_t at = begin(PatchOp_AddLink);
+        record_put(m_bytes, link);
+        end(at);
+    }
+
+    void GraphPatch::removeLink(const LinkKey& link)
+    {
+        std::size_t at = begin(PatchOp_RemoveLink);
+        record_put(m_bytes, link);
+        end(at);
+    }
+
+    static bool patch_link(ImNodeFlow& inf, const LinkKey& k, bool add)
+    {
+        auto& nodes = inf.getNodes();
+        auto outIt = nodes.find(static_cast<NodeUID>(k.outNode));
+        auto inIt = nodes.find(static_cast<NodeUID>(k.inNode));
+        if (outIt == nodes.end() || inIt == nodes.end())
+            return !add;
+        Pin* out = record_pin(*outIt->second, k.outPin, true);
+        Pin* in = record_pin(*inIt->second, k.inPin, false);
+        if (!out || !in)
+            return !add;
+
+        // createLink() toggles an existing link
+        std::shared_ptr<Link> l = in->getLink().lock();
+        bool linked = l && l->left() == out;
+        if (add && !linked) {
+            in->createLink(out);
+            l = in->getLink().lock();
+            return l && l->left() == out;
+        }
+        if (!add && linked)
+            in->deleteLink();
+        return true;
+    }
+
+    bool GraphPatch::apply(ImNodeFlow& inf, const NodeRegistry& registry) const
+    {
+        if (m_bytes.size() < patch_header || std::memcmp(m_bytes.data(), patch_magic, sizeof(patch_magic)) != 0)
+            return false;
+        RecordReader r{ m_bytes };
+        r.pos = sizeof(patch_magic);
+        if (r.get<uint32_t>() != patch_version)
+            return false;
+        auto count = r.get<uint32_t>();
+
+        auto& nodes = inf.getNodes();
+        bool ok = true;
+        inf.beginEdit();
+        for (uint32_t i = 0; i < count; i++) {
+            auto op = r.get<PatchOp>();
+            RecordReader p{ r.block() };
+            if (!r.ok) {
+                ok = false;
+                break;
+            }
+
+            switch (op) {
+                case PatchOp_AddNode:
+                case PatchOp_SetNode: {
+                    RecordReader peek = p;
+                    auto uid = static_cast<NodeUID>(peek.get<uint64_t>());
+                    auto it = nodes.find(uid);
+                    if (it != nodes.end()) {
+                        ImVec2 from = it->second->getPos();
+                        if (apply_node_record(registry, *it->second, p)) {
+                            if (from.x != it->second->getPos().x || from.y != it->second->getPos().y)
+                                inf.nodeMoved(it->second.get(), from);
+                            break;
+                        }
+                    }
+                    // Missing, or of another type
+                    if (it != nodes.end())
+                        inf.removeNode(uid);
+                    p.pos = 0;
+                    ok = read_node_record(registry, inf, p) != nullptr && ok;
+                    break;
+                }
+                case PatchOp_RemoveNode:
+                    inf.removeNode(static_cast<NodeUID>(p.get<uint64_t>()));
+                    break;
+                case PatchOp_MoveNode: {
+                    auto it = nodes.find(static_cast<NodeUID>(p.get<uint64_t>()));
+                    auto pos = p.get<ImVec2>();
+                    if (it != nodes.end() && p.ok) {
+                        ImVec2 from = it->second->getPos();
+                        it->second->setPos(pos);
+                        if (from.x != pos.x || from.y != pos.y)
+                            inf.nodeMoved(it->second.get(), from);
+                    } else
+                        ok = false;
+                    break;
+                }
+                case PatchOp_AddLink:
+                case PatchOp_RemoveLink: {
+                    auto k = p.get<LinkKey>();
+                    ok = p.ok && patch_link(inf, k, op == PatchOp_AddLink) && ok;
+                    break;
+                }
+                default:
+                    // Added by a later version: skipped
+                    break;
+            }
+        }
+        inf.endEdit();
+        return ok;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // SNAPSHOT
+
+    GraphSnapshot::Digest GraphSnapshot::digest(const NodeRegistry& registry, BaseNode& node, std::vector<std::byte>& scratch)
+    {
+        // Snapshot: [u64 uid][u32 type][ImVec2 pos][title, defaults, state]
+        static constexpr std::size_t posAt = sizeof(uint64_t) + sizeof(uint32_t);
+        scratch.clear();
+        write_node_record(registry, node, scratch);
+
+        uint64_t h = 14695981039346656037ull;
+        for (std::size_t i = 0; i < scratch.size(); i++) {
+            if (i == posAt)
+                i += sizeof(ImVec2);
+            h = (h ^ static_cast<uint64_t>(scratch[i])) * 1099511628211ull;
+        }
+        return { registry.typeOf(node), h, node.getPos() };
+    }
+
+    GraphSnapshot::GraphSnapshot(ImNodeFlow& inf, const NodeRegistry& registry)
+    {
+        std::vector<std::byte> scratch;
+        m_nodes.reserve(inf.getNodes().size());
+        for (auto &n: inf.getNodes()) { m_nodes.emplace(n.first, digest(registry, *n.second, scratch)); }
+        for (auto &l: inf.getLinks()) {
+            if (std::shared_ptr<Link> link = l.lock())
+                m_links.insert(LinkKey::of(*link));
+        }
+    }
+
+    GraphPatch GraphSnapshot::diff(ImNodeFlow& inf, const NodeRegistry& registry) const
+    {
+        GraphPatch p;
+        auto& nodes = inf.getNodes();
+        std::unordered_set<LinkKey, LinkKeyHash> links;
+        for (auto &l: inf.getLinks()) {
+            if (std::shared_ptr<Link> link = l.lock())
+                links.insert(LinkKey::of(*link));
+        }
+
+        // Links first, so that removing them doesn't depend on their nodes
+        for (auto &k: m_links) {
+            if (!links.count(k))
+                p.removeLink(k);
+        }
+        for (auto &n: m_nodes) {
+            if (!nodes.count(n.first))
+                p.removeNode(n.first);
+        }
+
+        std::vector<std::byte> scratch;
+        std::unordered_set<NodeUID> replaced;
+        for (auto &n: nodes) {
+            auto it = m_nodes.find(n.first);
+            if (it == m_nodes.end()) {
+                p.addNode(registry, *n.second);
+                continue;
+            }
+            Digest now = digest(registry, *n.second, scratch);
+            if (now.type != it->second.type) {
+                p.removeNode(n.first);
+                p.addNode(registry, *n.second);
+                replaced.insert(n.first);
+            } else if (now.hash != it->second.hash) {
+                p.setNode(registry, *n.second);
+            } else if (now.pos.x != it->second.pos.x || now.pos.y != it->second.pos.y) {
+                p.moveNode(n.first, now.pos);
+            }
+        }
+
+        // Replaced nodes come back without their links
+        for (auto &k: links) {
+            if (!m_links.count(k) || replaced.count(static_cast<NodeUID>(k.outNode)) || replaced.count(static_cast<NodeUID>(k.inNode)))
+                p.addLink(k);
+        }
+        return p;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // CHANGE TRACKER
+
+    ChangeTracker::ChangeTracker(ImNodeFlow& inf, const NodeRegistry& registry)
+      : m_inf(inf), m_registry(registry)
+    {
+        m_inf.addObserver(this);
+    }
+
+    ChangeTracker::~ChangeTracker()
+    {
+        m_inf.removeObserver(this);
+    }
+
+    void ChangeTracker::touch(NodeUID uid)
+    {
+        m_nodes.try_emplace(uid, NodeChange{ true }).first->second.changed = true;
+    }
+
+    void ChangeTracker::nodeAdded(BaseNode& node)
+    {
+        auto [it, fresh] = m_nodes.try_emplace(node.getUID(), NodeChange{ false });
+        if (!fresh && it->second.existed)
+            it->second.replaced = true;
+    }
+
+    void ChangeTracker::nodeRemoved(BaseNode& node)
+    {
+        m_nodes.try_emplace(node.getUID(), NodeChange{ true });
+    }
+
+    void ChangeTracker::nodeMoved(BaseNode& node, [[maybe_unused]] const ImVec2& from)
+    {
+        m_nodes.try_emplace(node.getUID(), NodeChange{ true }).first->second.moved = true;
+    }
+
+    void ChangeTracker::linkAdded(Link& link)
+    {
+        auto it = m_links.try_emplace(LinkKey::of(link), 0).first;
+        if (++it->second == 0)
+            m_links.erase(it);
+    }
+
+    void ChangeTracker::linkRemoved(Link& link)
+    {
+        auto it = m_links.try_emplace(LinkKey::of(link), 0).first;
+        if (--it->second == 0)
+            m_links.erase(it);
+    }
+
+    GraphPatch ChangeTracker::take()
+    {
+        GraphPatch p;
+        auto& nodes = m_inf.getNodes();
+
+        for (auto &l: m_links) {
+            if (l.second < 0)
+                p.removeLink(l.first);
+        }
+        for (auto &n: m_nodes) {
+            if (n.second.existed && (n.second.replaced || !nodes.count(n.first)))
+                p.removeNode(n.first);
+        }
+        for (auto &n: m_nodes) {
+            auto it = nodes.find(n.first);
+            if (it == nodes.end())
+                continue;
+            const NodeChange& c = n.second;
+            if (!c.existed || c.replaced)
+                p.addNode(m_registry, *it->second);
+            else if (c.changed)
+                p.setNode(m_registry, *it->second);
+            else if (c.moved)
+                p.moveNode(n.first, it->second->getPos());
+        }
+        for (auto &l: m_links) {
+            if (l.second > 0)
+                p.addLink(l.first);
+        }
+
+        // Replaced nodes come back without their links
+        for (auto &n: m_nodes) {
+            auto it = nodes.find(n.first);
+            if (!n.second.replaced || it == nodes.end())
+                continue;
+            for (Link* l: it->second->upstreamLinks()) { p.addLink(LinkKey::of(*l)); }
+            for (Link* l: it->second->downstreamLinks()) { p.addLink(LinkKey::of(*l)); }
+        }
+
+        clear();
+        return p;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // CHANNEL
+
+    static bool write_all(int fd, const std::byte* data, std::size_t size)
+    {
+        while (size > 0) {
+#ifdef _WIN32
+            int n = _write(fd, data, static_cast<unsigned>(std::min<std::size_t>(size, 1u << 30)));
+#else
+            ssize_t n = ::write(fd, data, size);
+#endif
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            data += n;
+            size -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    static bool read_all(int fd, std::byte* data, std::size_t size)
+    {
+        while (size > 0) {
+#ifdef _WIN32
+            int n = _read(fd, data, static_cast<unsigned>(std::min<std::size_t>(size, 1u << 30)));
+#else
+            ssize_t n = ::read(fd, data, size);
+#endif
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            data += n;
+            size -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    bool PatchChannel::send(const GraphPatch& patch)
+    {
+        std::span<const std::byte> bytes = patch.bytes();
+        auto size = static_cast<uint64_t>(bytes.size());
+        return m_write >= 0 && write_all(m_write, reinterpret_cast<const std::byte*>(&size), sizeof(size)) &&
+               write_all(m_write, bytes.data(), bytes.size());
+    }
+
+    bool PatchChannel::receive(GraphPatch& patch)
+    {
+        uint64_t size = 0;
+        if (m_read < 0 || !read_all(m_read, reinterpret_cast<std::byte*>(&size), sizeof(size)) || size < patch_header || size > m_maxFrame)
+            return false;
+        std::vector<std::byte> bytes(static_cast<std::size_t>(size));
+        if (!read_all(m_read, bytes.data(), bytes.size()))
+            return false;
+        patch = GraphPatch(std::move(bytes));
+        return true;
+    }
+}
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <imgui.h>
+#include "graph_observer.h"
+#include "node_registry.h"
+
+namespace ImFlow
+{
+    typedef uintptr_t NodeUID;
+
+    /**
+     * @brief Kind of a patch record
+     */
+    enum PatchOp : uint8_t
+    {
+        PatchOp_AddNode,    // Node snapshot, created with its UID (updated if it exists)
+        PatchOp_RemoveNode, // Node UID
+        PatchOp_MoveNode,   // Node UID and position
+        PatchOp_SetNode,    // Node snapshot, applied to the node with its UID (created if missing)
+        PatchOp_AddLink,    // Node and pin UIDs of both ends
+        PatchOp_RemoveLink  // Same payload
+    };
+
+    /**
+     * @brief Link identified by the UIDs of its ends
+     */
+    struct LinkKey
+    {
+        uint64_t outNode = 0;
+        uint64_t outPin = 0;
+        uint64_t inNode = 0;
+        uint64_t inPin = 0;
+
+        bool operator==(const LinkKey&) const = default;
+
+        /**
+         * @brief <BR>Get the key of a link
+         * @param link Link to identify
+         * @return Key of the link
+         */
+        static LinkKey of(const Link& link) noexcept(true);
+    };
+
+    struct LinkKeyHash
+    {
+        std::size_t operator()(const LinkKey& k) const noexcept(true)
+        {
+            uint64_t h = k.outNode * 0x9E3779B97F4A7C15ull;
+            h = (h ^ k.outPin) * 0x9E3779B97F4A7C15ull;
+            h = (h ^ k.inNode) * 0x9E3779B97F4A7C15ull;
+            h = (h ^ k.inPin) * 0x9E3779B97F4A7C15ull;
+            return static_cast<std::size_t>(h ^ (h >> 32));
+        }
+    };
+
+    /**
+     * @brief Set of edits turning one state of a graph into another, keyed by node and pin UIDs
+     * @details Self-contained bytes: send them to another process and apply them to its copy of the graph.
+     *          Applying is idempotent, so a patch echoed back by the other side changes nothing.
+     */
+    class GraphPatch
+    {
+    public:
+        /***/
+        GraphPatch();
+
+        /**
+         * @brief <BR>Take the bytes of a patch
+         * @param bytes Bytes returned by bytes(), checked by apply()
+         */
+        explicit GraphPatch(std::vector<std::byte> bytes) noexcept(true)
+          : m_bytes(std::move(bytes))
+        {}
+
+        void addNode(const NodeRegistry& registry, BaseNode& node);
+        void setNode(const NodeRegistry& registry, BaseNode& node);
+        void removeNode(NodeUID uid);
+        void moveNode(NodeUID uid, const ImVec2& pos);
+        void addLink(const LinkKey& link);
+        void removeLink(const LinkKey& link);
+
+        /**
+         * @brief <BR>Apply the edits to a graph
+         * @details Wrapped in ImNodeFlow::beginEdit()/endEdit(). Must not be called from within update().
+         * @param inf Handler to edit
+         * @param registry Registry creating the nodes
+         * @return [FALSE] if the bytes are malformed, or an edit couldn't be applied (unregistered type, missing end of a link)
+         */
+        bool apply(ImNodeFlow& inf, const NodeRegistry& registry = node_registry()) const;
+
+        /**
+         * @brief <BR>Get the serialized patch
+         * @return View of the bytes
+         */
+        [[nodiscard]] std::span<const std::byte> bytes() const noexcept(true)
+        { return m_bytes; }
+
+        /**
+         * @brief <BR>Get number of edits
+         * @return Number of records
+         */
+        [[nodiscard]] uint32_t size() const noexcept(true);
+
+        [[nodiscard]] bool empty() const noexcept(true) { return size() == 0; }
+
+    private:
+        std::size_t begin(PatchOp op);
+        void end(std::size_t at);
+
+        std::vector<std::byte> m_bytes;
+    };
+
+    /**
+     * @brief Digest of the state of a graph, to diff against later
+     * @details Holds a hash per node and the keys of the links, not the nodes themselves.
+     */
+    class GraphSnapshot
+    {
+    public:
+        /**
+         * @brief <BR>Snapshot of an empty graph
+         * @details Diffing against it gives a patch recreating the whole graph.
+         */
+        GraphSnapshot() = default;
+
+        /**
+         * @brief <BR>Take the snapshot of a graph
+         * @param inf Handler to digest
+         * @param registry Registry giving the types and states of the nodes
+         */
+        explicit GraphSnapshot(ImNodeFlow& inf, const NodeRegistry& registry = node_registry());
+
+        /**
+         * @brief <BR>Compute the patch from this state to the current state of a graph
+         * @details Visits the whole graph. Use a ChangeTracker to avoid it.
+         * @param inf Handler holding the new state
+         * @param registry Registry giving the types and states of the nodes
+         * @return Patch turning this state into the state of the handler
+         */
+        [[nodiscard]] GraphPatch diff(ImNodeFlow& inf, const NodeRegistry& registry = node_registry()) const;
+
+        [[nodiscard]] std::size_t nodeCount() const noexcept(true) { return m_nodes.size(); }
+        [[nodiscard]] std::size_t linkCount() const noexcept(true) { return m_links.size(); }
+
+    private:
+        struct Digest
+        {
+            uint32_t type;
+            uint64_t hash; // Of everything but the position
+            ImVec2   pos;
+        };
+
+        static Digest digest(const NodeRegistry& registry, BaseNode& node, std::vector<std::byte>& scratch);
+
+        std::unordered_map<NodeUID, Digest>      m_nodes;
+        std::unordered_set<LinkKey, LinkKeyHash> m_links;
+    };
+
+    /**
+     * @brief Collects the edits of a graph as they happen, to send them as a patch
+     * @details Building the patch costs O(changes): only the nodes and links edited since the last take() are visited.
+     *          Changes of values (input defaults, node state) aren't edits: report them with touch().
+     *          <BR> Must be destroyed before its handler.
+     */
+    class ChangeTracker : public GraphObserver
+    {
+    public:
+        /**
+         * @brief <BR>Start tracking
+         * @param inf Handler to track
+         * @param registry Registry giving the types and states of the nodes
+         */
+        explicit ChangeTracker(ImNodeFlow& inf, const NodeRegistry& registry = node_registry());
+
+        ~ChangeTracker() override;
+
+        ChangeTracker(const ChangeTracker&) = delete;
+        ChangeTracker& operator=(const ChangeTracker&) = delete;
+
+        /**
+         * @brief <BR>Report a change of the values of a node
+         * @param uid UID of the node
+         */
+        void touch(NodeUID uid);
+
+        /**
+         * @brief <BR>Get change status
+         * @return [TRUE] if nothing changed since the last take()
+         */
+        [[nodiscard]] bool empty() const noexcept(true)
+        { return m_nodes.empty() && m_links.empty(); }
+
+        /**
+         * @brief <BR>Build the patch of the changes since the last call, and forget them
+         * @return Patch to apply to a graph in the state of the last call
+         */
+        GraphPatch take();
+
+        /**
+         * @brief <BR>Forget the changes
+         */
+        void clear() noexcept(true)
+        { m_nodes.clear(); m_links.clear(); }
+
+        void nodeAdded(BaseNode& node) override;
+        void nodeRemoved(BaseNode& node) override;
+        void nodeMoved(BaseNode& node, const ImVec2& from) override;
+        void linkAdded(Link& link) override;
+        void linkRemoved(Link& link) override;
+
+    private:
+        struct NodeChange
+        {
+            bool existed;          // Before the first change
+            bool replaced = false; // Removed then added again
+            bool moved = false;
+            bool changed = false;
+        };
+
+        ImNodeFlow&                                   m_inf;
+        const NodeRegistry&                           m_registry;
+        std::unordered_map<NodeUID, NodeChange>       m_nodes;
+        std::unordered_map<LinkKey, int, LinkKeyHash> m_links; // Net count: +1 added, -1 removed
+    };
+
+    /**
+     * @brief Sends and receives patches over a pipe or a socket
+     * @details Each patch is framed by its size. Calls block until the whole patch is written or read.
+     */
+    class PatchChannel
+    {
+    public:
+        /**
+         * @brief <BR>Use open file descriptors
+         * @param readFd Descriptor patches are received from, -1 for none
+         * @param writeFd Descriptor patches are sent to, -1 for none. The same as readFd for a socket
+         */
+        PatchChannel(int readFd, int writeFd) noexcept(true)
+          : m_read(readFd), m_write(writeFd)
+        {}
+
+        /**
+         * @brief <BR>Send a patch
+         * @param patch Patch to send
+         * @return [FALSE] if writing failed
+         */
+        bool send(const GraphPatch& patch);
+
+        /**
+         * @brief <BR>Receive a patch
+         * @details After a failure the stream is out of sync: close the channel.
+         * @param patch Patch replaced by the one received
+         * @return [FALSE] at the end of the stream, if reading failed, or if the frame exceeds the maximum size
+         */
+        bool receive(GraphPatch& patch);
+
+        /**
+         * @brief <BR>Set the largest patch accepted by receive()
+         * @details Checked before anything is allocated, so that a corrupt or hostile peer can't exhaust the memory.
+         * @param bytes Maximum size of a frame, 256MB by default
+         */
+        void setMaxFrame(std::size_t bytes) noexcept(true)
+        { m_maxFrame = bytes; }
+
+    private:
+        int         m_read;
+        int         m_write;
+        std::size_t m_maxFrame = std::size_t(256) << 20;
+    };
+}
@@ -0,0 +1,445 @@
+#include "ImNodeFlow.h"
+#include "journal.h"
+#include "graph_binary.h"
+#include "node_record.h"
+#include "paged_graph.h"
+
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ImFlow
+{
+    // Record: [u32 size of op and payload][u32 checksum of op and payload][u8 op][payload]
+    static constexpr char     journal_magic[4] = { 'I', 'N', 'F', 'J' };
+    static constexpr uint32_t journal_version = 1;
+    static constexpr std::size_t journal_header = 8;
+    static constexpr std::size_t record_header = 8;
+
+    static uint32_t fnv1a(std::span<const std::byte> bytes) noexcept(true)
+    {
+        uint32_t h = 2166136261u;
+        for (std::byte b: bytes) { h = (h ^ static_cast<uint32_t>(b)) * 16777619u; }
+        return h;
+    }
+
+    static bool write_journal_header(std::FILE* f) noexcept(true)
+    {
+        return std::fwrite(journal_magic, 1, sizeof(journal_magic), f) == sizeof(journal_magic) &&
+               std::fwrite(&journal_version, 1, sizeof(journal_version), f) == sizeof(journal_version);
+    }
+
+    static bool sync_file(std::FILE* f) noexcept(true)
+    {
+        if (std::fflush(f) != 0)
+            return false;
+#ifdef _WIN32
+        return _commit(_fileno(f)) == 0;
+#else
+        return ::fsync(fileno(f)) == 0;
+#endif
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // JOURNAL
+
+    Journal::Journal(ImNodeFlow& inf, std::string path, const NodeRegistry& registry)
+      : m_inf(inf), m_registry(registry), m_path(std::move(path)), m_lastSync(std::chrono::steady_clock::now())
+    {
+        m_file = std::fopen(m_path.c_str(), "ab");
+        if (m_file && std::fseek(m_file, 0, SEEK_END) == 0 && std::ftell(m_file) == 0) {
+            if (!write_journal_header(m_file) || !sync_file(m_file)) {
+                std::fclose(m_file);
+                m_file = nullptr;
+            }
+        }
+        m_inf.addObserver(this);
+    }
+
+    Journal::~Journal()
+    {
+        m_inf.removeObserver(this);
+        if (m_file) {
+            flush();
+            std::fclose(m_file);
+        }
+    }
+
+    void Journal::encodeNode(JournalOp op, BaseNode& node)
+    {
+        m_scratch.assign(record_header, std::byte{});
+        record_put(m_scratch, op);
+        write_node_record(m_registry, node, m_scratch);
+        seal();
+    }
+
+    void Journal::encodeLink(JournalOp op, Link& link)
+    {
+        encodeLink(op, static_cast<uint64_t>(link.left()->getParent()->getUID()), static_cast<uint64_t>(link.left()->getUid()),
+                   static_cast<uint64_t>(link.right()->getParent()->getUID()), static_cast<uint64_t>(link.right()->getUid()));
+    }
+
+    void Journal::encodeLink(JournalOp op, uint64_t outNode, uint64_t outPin, uint64_t inNode, uint64_t inPin)
+    {
+        m_scratch.assign(record_header, std::byte{});
+        record_put(m_scratch, op);
+        record_put(m_scratch, outNode);
+        record_put(m_scratch, outPin);
+        record_put(m_scratch, inNode);
+        record_put(m_scratch, inPin);
+        seal();
+    }
+
+    void Journal::seal()
+    {
+        auto size = static_cast<uint32_t>(m_scratch.size() - record_header);
+        uint32_t sum = fnv1a(std::span(m_scratch).subspan(record_header));
+        std::memcpy(m_scratch.data(), &size, sizeof(size));
+        std::memcpy(m_scratch.data() + sizeof(size), &sum, sizeof(sum));
+    }
+
+    void Journal::invert(std::span<const std::byte> rec)
+    {
+        m_scratch.assign(rec.begin(), rec.end());
+        auto& op = reinterpret_cast<JournalOp&>(m_scratch[record_header]);
+        switch (op) {
+            case JournalOp_AddNode:    op = JournalOp_RemoveNode; break;
+            case JournalOp_RemoveNode: op = JournalOp_AddNode; break;
+            case JournalOp_AddLink:    op = JournalOp_RemoveLink; break;
+            case JournalOp_RemoveLink: op = JournalOp_AddLink; break;
+            case JournalOp_MoveNode: {
+                // Swap the positions after the op and the node UID
+                std::byte* from = m_scratch.data() + record_header + 1 + sizeof(uint64_t);
+                std::swap_ranges(from, from + sizeof(ImVec2), from + sizeof(ImVec2));
+                break;
+            }
+        }
+        seal();
+    }
+
+    void Journal::record()
+    {
+        append(m_scratch);
+
+        // A new edit drops the undone steps
+        if (m_cursor < m_steps.size()) {
+            std::size_t first = m_steps[m_cursor];
+            m_history.resize(first < m_offsets.size() ? m_offsets[first] : m_history.size());
+            m_offsets.resize(first);
+            m_steps.resize(m_cursor);
+        }
+        if (!m_stepOpen) {
+            m_steps.push_back(m_offsets.size());
+            m_cursor = m_steps.size();
+            m_stepOpen = m_depth > 0;
+        }
+        m_offsets.push_back(m_history.size());
+        m_history.insert(m_history.end(), m_scratch.begin(), m_scratch.end());
+
+        if (m_depth == 0)
+            maybeSync();
+    }
+
+    void Journal::append(std::span<const std::byte> rec)
+    {
+        if (!m_file)
+            return;
+        m_pending.insert(m_pending.end(), rec.begin(), rec.end());
+        m_fileRecords++;
+    }
+
+    std::span<const std::byte> Journal::historyRecord(std::size_t i) const noexcept(true)
+    {
+        std::size_t end = i + 1 < m_offsets.size() ? m_offsets[i + 1] : m_history.size();
+        return std::span(m_history).subspan(m_offsets[i], end - m_offsets[i]);
+    }
+
+    bool Journal::apply(std::span<const std::byte> rec)
+    {
+        RecordReader r{ rec.subspan(record_header) };
+        auto op = r.get<JournalOp>();
+        if (op == JournalOp_AddNode)
+            return read_node_record(m_registry, m_inf, r) != nullptr;
+        auto uid = static_cast<NodeUID>(r.get<uint64_t>());
+        auto& nodes = m_inf.getNodes();
+
+        switch (op) {
+            case JournalOp_RemoveNode:
+                return r.ok && m_inf.removeNode(uid);
+            case JournalOp_MoveNode: {
+                (void)r.get<ImVec2>();
+                ImVec2 to = r.get<ImVec2>();
+                auto it = nodes.find(uid);
+                if (!r.ok || it == nodes.end())
+                    return false;
+                ImVec2 from = it->second->getPos();
+                it->second->setPos(to);
+                m_inf.nodeMoved(it->second.get(), from);
+                return true;
+            }
+            case JournalOp_AddLink:
+            case JournalOp_RemoveLink: {
+                auto outPin = static_cast<PinUID>(r.get<uint64_t>());
+                auto inNode = static_cast<NodeUID>(r.get<uint64_t>());
+                auto inPin = static_cast<PinUID>(r.get<uint64_t>());
+                auto outIt = nodes.find(uid);
+                auto inIt = nodes.find(inNode);
+                if (!r.ok || outIt == nodes.end() || inIt == nodes.end())
+                    return false;
+                Pin* out = record_pin(*outIt->second, outPin, true);
+                Pin* in = record_pin(*inIt->second, inPin, false);
+                if (!out || !in)
+                    return false;
+                // createLink() toggles an existing link
+                std::shared_ptr<Link> l = in->getLink().lock();
+                bool linked = l && l->left() == out;
+                if (op == JournalOp_AddLink && !linked)
+                    in->createLink(out);
+                else if (op == JournalOp_RemoveLink && linked)
+                    in->deleteLink();
+                return true;
+            }
+            case JournalOp_AddNode:
+                break;
+        }
+        return false;
+    }
+
+    bool Journal::recover()
+    {
+        MappedFile file(m_path);
+        std::span<const std::byte> bytes = file.bytes();
+        if (!file.isOpen() || bytes.size() < journal_header || std::memcmp(bytes.data(), journal_magic, sizeof(journal_magic)) != 0)
+            return false;
+        uint32_t version;
+        std::memcpy(&version, bytes.data() + sizeof(journal_magic), sizeof(version));
+        if (version != journal_version)
+            return false;
+
+        std::size_t pos = journal_header;
+        std::size_t count = 0;
+        bool torn = false;
+        m_applying = true;
+        m_inf.beginEdit();
+        while (pos < bytes.size()) {
+            uint32_t size, sum;
+            if (bytes.size() - pos < record_header + 1) {
+                torn = true;
+                break;
+            }
+            std::memcpy(&size, bytes.data() + pos, sizeof(size));
+            std::memcpy(&sum, bytes.data() + pos + sizeof(size), sizeof(sum));
+            if (size == 0 || size > bytes.size() - pos - record_header || fnv1a(bytes.subspan(pos + record_header, size)) != sum) {
+                torn = true;
+                break;
+            }
+            (void)apply(bytes.subspan(pos, record_header + size));
+            pos += record_header + size;
+            count++;
+        }
+        m_inf.endEdit();
+        m_applying = false;
+
+        m_fileRecords = count;
+        if (torn)
+            checkpoint();
+        return true;
+    }
+
+    void Journal::clearHistory() noexcept(true)
+    {
+        m_history.clear();
+        m_offsets.clear();
+        m_steps.clear();
+        m_cursor = 0;
+        m_stepOpen = false;
+    }
+
+    bool Journal::undo()
+    {
+        if (!canUndo() || m_depth > 0)
+            return false;
+        std::size_t step = --m_cursor;
+        std::size_t first = m_steps[step];
+        std::size_t last = step + 1 < m_steps.size() ? m_steps[step + 1] : m_offsets.size();
+
+        m_applying = true;
+        m_inf.beginEdit();
+        for (std::size_t i = last; i-- > first;) {
+            invert(historyRecord(i));
+            (void)apply(m_scratch);
+            append(m_scratch);
+        }
+        m_inf.endEdit();
+        m_applying = false;
+        maybeSync();
+        return true;
+    }
+
+    bool Journal::redo()
+    {
+        if (!canRedo() || m_depth > 0)
+            return false;
+        std::size_t step = m_cursor++;
+        std::size_t first = m_steps[step];
+        std::size_t last = step + 1 < m_steps.size() ? m_steps[step + 1] : m_offsets.size();
+
+        m_applying = true;
+        m_inf.beginEdit();
+        for (std::size_t i = first; i < last; i++) {
+            (void)apply(historyRecord(i));
+            append(historyRecord(i));
+        }
+        m_inf.endEdit();
+        m_applying = false;
+        maybeSync();
+        return true;
+    }
+
+    void Journal::maybeSync()
+    {
+        if (!m_file)
+            return;
+        if (m_checkpointEvery && m_fileRecords >= m_checkpointEvery)
+            checkpoint();
+        else if (!m_pending.empty() && std::chrono::steady_clock::now() - m_lastSync >= m_syncInterval)
+            flush();
+    }
+
+    bool Journal::flush()
+    {
+        if (!m_file)
+            return false;
+        bool ok = true;
+        if (!m_pending.empty()) {
+            ok = std::fwrite(m_pending.data(), 1, m_pending.size(), m_file) == m_pending.size();
+            ok = sync_file(m_file) && ok;
+            m_pending.clear();
+        }
+        m_lastSync = std::chrono::steady_clock::now();
+        return ok;
+    }
+
+    bool Journal::checkpoint()
+    {
+        std::string tmp = m_path + ".tmp";
+        std::FILE* f = std::fopen(tmp.c_str(), "wb");
+        if (!f)
+            return false;
+
+        bool ok = write_journal_header(f);
+        auto write = [&]() { ok = ok && std::fwrite(m_scratch.data(), 1, m_scratch.size(), f) == m_scratch.size(); };
+        for (auto &n: m_inf.getNodes()) {
+            encodeNode(JournalOp_AddNode, *n.second);
+            write();
+        }
+        for (auto &l: m_inf.getLinks()) {
+            std::shared_ptr<Link> link = l.lock();
+            if (!link)
+                continue;
+            encodeLink(JournalOp_AddLink, *link);
+            write();
+        }
+        // Paged-out nodes aren't in the handler, but are part of the graph
+        if (PagedGraph* pages = m_inf.getPagedGraph()) {
+            ok = pages->readPages([&](std::span<const std::byte> node)
+                                  {
+                                      m_scratch.assign(record_header, std::byte{});
+                                      record_put(m_scratch, JournalOp_AddNode);
+                                      m_scratch.insert(m_scratch.end(), node.begin(), node.end());
+                                      seal();
+                                      write();
+                                  },
+                                  [&](uint64_t outNode, uint64_t outPin, uint64_t inNode, uint64_t inPin)
+                                  {
+                                      encodeLink(JournalOp_AddLink, outNode, outPin, inNode, inPin);
+                                      write();
+                                  }) && ok;
+        }
+        ok = sync_file(f) && ok;
+        std::fclose(f);
+
+        std::error_code ec;
+        if (ok) {
+            if (m_file)
+                std::fclose(m_file);
+            std::filesystem::rename(tmp, m_path, ec);
+            m_file = std::fopen(m_path.c_str(), "ab");
+        }
+        if (!ok || ec) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        m_pending.clear();
+        m_fileRecords = 0;
+        m_lastSync = std::chrono::steady_clock::now();
+        return m_file != nullptr;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // OBSERVER
+
+    void Journal::nodeAdded(BaseNode& node)
+    {
+        if (m_applying)
+            return;
+        encodeNode(JournalOp_AddNode, node);
+        record();
+    }
+
+    void Journal::nodeRemoved(BaseNode& node)
+    {
+        if (m_applying)
+            return;
+        encodeNode(JournalOp_RemoveNode, node);
+        record();
+    }
+
+    void Journal::nodeMoved(BaseNode& node, const ImVec2& from)
+    {
+        if (m_applying)
+            return;
+        m_scratch.assign(record_header, std::byte{});
+        record_put(m_scratch, JournalOp_MoveNode);
+        record_put(m_scratch, static_cast<uint64_t>(node.getUID()));
+        record_put(m_scratch, from);
+        record_put(m_scratch, node.getPos());
+        seal();
+        record();
+    }
+
+    void Journal::linkAdded(Link& link)
+    {
+        if (m_applying)
+            return;
+        encodeLink(JournalOp_AddLink, link);
+        record();
+    }
+
+    void Journal::linkRemoved(Link& link)
+    {
+        if (m_applying)
+            return;
+        encodeLink(JournalOp_RemoveLink, link);
+        record();
+    }
+
+    void Journal::editBegin()
+    {
+        if (!m_applying)
+            m_depth++;
+    }
+
+    void Journal::editEnd()
+    {
+        if (m_applying || m_depth == 0 || --m_depth > 0)
+            return;
+        m_stepOpen = false;
+        maybeSync();
+    }
+}
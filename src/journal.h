@@ -0,0 +1,165 @@
+#pragma once
+
+#include <span>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "graph_observer.h"
+#include "node_registry.h"
+
+namespace ImFlow
+{
+    /**
+     * @brief Kind of a journal record
+     */
+    enum JournalOp : uint8_t
+    {
+        JournalOp_AddNode,    // Type, position, title, input defaults and state of the node
+        JournalOp_RemoveNode, // Same payload, so that it can be undone
+        JournalOp_MoveNode,   // Position before and after
+        JournalOp_AddLink,    // Node and pin UIDs of both ends
+        JournalOp_RemoveLink  // Same payload
+    };
+
+    /**
+     * @brief Append-only log of the structural edits of a graph, with undo/redo and crash recovery
+     * @details Each edit is recorded once, in memory for the undo history and in the journal file. Undoing applies the
+     *          inverse record: no snapshot is taken. The file is appended in batches synced at most every sync interval,
+     *          and rewritten as the current graph (checkpoint) every so many records, so that replaying it stays short.
+     *          <BR> Nodes are recreated through the registry: nodes of unregistered types can be undone but not redone.
+     *          <BR> Must be destroyed before its handler. undo(), redo() and checkpoint() must not be called from within update().
+     */
+    class Journal : public GraphObserver
+    {
+    public:
+        /**
+         * @brief <BR>Open the journal file and start recording
+         * @param inf Handler to record
+         * @param path Path of the journal file, created if needed. Check isOpen() for failures
+         * @param registry Registry creating the nodes when undoing, redoing and recovering
+         */
+        Journal(ImNodeFlow& inf, std::string path, const NodeRegistry& registry = node_registry());
+
+        /**
+         * @brief <BR>Stop recording, and sync the pending records
+         */
+        ~Journal() override;
+
+        Journal(const Journal&) = delete;
+        Journal& operator=(const Journal&) = delete;
+
+        /**
+         * @brief <BR>Get file status
+         * @return [TRUE] if the journal file is open
+         */
+        [[nodiscard]] bool isOpen() const noexcept(true) { return m_file != nullptr; }
+
+        /**
+         * @brief <BR>Rebuild the graph recorded by the journal file
+         * @details Call once, on an empty graph, before editing it. Records after a torn or corrupted one are dropped,
+         *          and the file is then rewritten.
+         * @return [FALSE] if the file isn't a journal
+         */
+        bool recover();
+
+        [[nodiscard]] bool canUndo() const noexcept(true) { return m_cursor > 0; }
+        [[nodiscard]] bool canRedo() const noexcept(true) { return m_cursor < m_steps.size(); }
+
+        /**
+         * @brief <BR>Revert the last edit
+         * @details An edit is a group of records (see GraphObserver::editBegin()), e.g. all the edits made by one update().
+         * @return [FALSE] if there's nothing to undo
+         */
+        bool undo();
+
+        /**
+         * @brief <BR>Apply again the last reverted edit
+         * @return [FALSE] if there's nothing to redo
+         */
+        bool redo();
+
+        /**
+         * @brief <BR>Forget the undo history
+         */
+        void clearHistory() noexcept(true);
+
+        /**
+         * @brief <BR>Write the pending records and sync the file
+         * @return [FALSE] if writing failed
+         */
+        bool flush();
+
+        /**
+         * @brief <BR>Rewrite the file as the current graph
+         * @details The new file is written aside and renamed over the journal, so that a crash leaves one of the two.
+         *          Nodes paged out by a PagedGraph are written from their pages.
+         * @return [FALSE] if writing failed
+         */
+        bool checkpoint();
+
+        /**
+         * @brief <BR>Set the maximum delay between an edit and its sync to the disk
+         * @param interval Interval, 0 syncs every edit
+         */
+        void setSyncInterval(std::chrono::milliseconds interval) noexcept(true)
+        { m_syncInterval = interval; }
+
+        /**
+         * @brief <BR>Set the number of records after which the file is checkpointed
+         * @param records Number of records, 0 disables automatic checkpoints
+         */
+        void setCheckpointInterval(std::size_t records) noexcept(true)
+        { m_checkpointEvery = records; }
+
+        /**
+         * @brief <BR>Get number of records appended since the last checkpoint
+         * @return Number of records
+         */
+        [[nodiscard]] std::size_t fileRecords() const noexcept(true)
+        { return m_fileRecords; }
+
+        void nodeAdded(BaseNode& node) override;
+        void nodeRemoved(BaseNode& node) override;
+        void nodeMoved(BaseNode& node, const ImVec2& from) override;
+        void linkAdded(Link& link) override;
+        void linkRemoved(Link& link) override;
+        void editBegin() override;
+        void editEnd() override;
+
+    private:
+        void encodeNode(JournalOp op, BaseNode& node);
+        void encodeLink(JournalOp op, Link& link);
+        void encodeLink(JournalOp op, uint64_t outNode, uint64_t outPin, uint64_t inNode, uint64_t inPin);
+        void seal();
+        void record();
+        void invert(std::span<const std::byte> rec);
+        void append(std::span<const std::byte> rec);
+        bool apply(std::span<const std::byte> rec);
+        void maybeSync();
+        [[nodiscard]] std::span<const std::byte> historyRecord(std::size_t i) const noexcept(true);
+
+        ImNodeFlow&           m_inf;
+        const NodeRegistry&   m_registry;
+        std::string           m_path;
+        std::FILE*            m_file = nullptr;
+        std::vector<std::byte> m_pending;
+        std::vector<std::byte> m_scratch;
+
+        std::chrono::steady_clock::time_point m_lastSync;
+        std::chrono::milliseconds             m_syncInterval{200};
+        std::size_t                           m_checkpointEvery = 10000;
+        std::size_t                           m_fileRecords = 0;
+
+        // Undo history: records back to back, the start of each one, and the first record of each step
+        std::vector<std::byte>   m_history;
+        std::vector<std::size_t> m_offsets;
+        std::vector<std::size_t> m_steps;
+        std::size_t              m_cursor = 0;
+        int                      m_depth = 0;
+        bool                     m_stepOpen = false;
+        bool                     m_applying = false;
+    };
+}
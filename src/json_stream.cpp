@@ -0,0 +1,432 @@
+#include "json_stream.h"
+
+#include <cmath>
+#include <cstdio>
+#include <charconv>
+
+namespace ImFlow
+{
+    // -----------------------------------------------------------------------------------------------------------------
+    // WRITER
+
+    void JsonWriter::separator()
+    {
+        if (m_afterKey) {
+            m_afterKey = false;
+            return;
+        }
+        if (!m_first.empty()) {
+            if (!m_first.back())
+                m_out.put(',');
+            m_first.back() = false;
+        }
+        if (m_lineBreak) {
+            m_out.put('\n');
+            m_lineBreak = false;
+        }
+    }
+
+    void JsonWriter::quoted(std::string_view s)
+    {
+        static const char digits[] = "0123456789abcdef";
+        m_out.put('"');
+        std::size_t run = 0;
+        for (std::size_t i = 0; i < s.size(); i++) {
+            auto c = static_cast<unsigned char>(s[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+            m_out.write(s.data() + run, static_cast<std::streamsize>(i - run));
+            run = i + 1;
+            switch (c) {
+                case '"':  m_out << "\\\""; break;
+                case '\\': m_out << "\\\\"; break;
+                case '\n': m_out << "\\n"; break;
+                case '\r': m_out << "\\r"; break;
+                case '\t': m_out << "\\t"; break;
+                default:
+                    m_out << "\\u00" << digits[c >> 4] << digits[c & 15];
+            }
+        }
+        m_out.write(s.data() + run, static_cast<std::streamsize>(s.size() - run));
+        m_out.put('"');
+    }
+
+    JsonWriter& JsonWriter::beginObject()
+    {
+        separator();
+        m_out.put('{');
+        m_first.push_back(true);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::endObject()
+    {
+        m_first.pop_back();
+        if (m_lineBreak) {
+            m_out.put('\n');
+            m_lineBreak = false;
+        }
+        m_out.put('}');
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::beginArray()
+    {
+        separator();
+        m_out.put('[');
+        m_first.push_back(true);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::endArray()
+    {
+        m_first.pop_back();
+        if (m_lineBreak) {
+            m_out.put('\n');
+            m_lineBreak = false;
+        }
+        m_out.put(']');
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::key(std::string_view k)
+    {
+        separator();
+        quoted(k);
+        m_out.put(':');
+        m_afterKey = true;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::string(std::string_view s)
+    {
+        separator();
+        quoted(s);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::number(double v)
+    {
+        separator();
+        if (!std::isfinite(v)) {
+            m_out << "null";
+            return *this;
+        }
+        char buf[32];
+        auto r = std::to_chars(buf, buf + sizeof(buf), v);
+        m_out.write(buf, r.ptr - buf);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::integer(int64_t v)
+    {
+        separator();
+        char buf[24];
+        auto r = std::to_chars(buf, buf + sizeof(buf), v);
+        m_out.write(buf, r.ptr - buf);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::uinteger(uint64_t v)
+    {
+        separator();
+        char buf[24];
+        auto r = std::to_chars(buf, buf + sizeof(buf), v);
+        m_out.write(buf, r.ptr - buf);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::boolean(bool v)
+    {
+        separator();
+        m_out << (v ? "true" : "false");
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::null()
+    {
+        separator();
+        m_out << "null";
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::hex(std::span<const std::byte> bytes)
+    {
+        static const char digits[] = "0123456789abcdef";
+        separator();
+        m_out.put('"');
+        for (std::byte b: bytes) {
+            auto v = static_cast<unsigned>(b);
+            m_out.put(digits[v >> 4]);
+            m_out.put(digits[v & 15]);
+        }
+        m_out.put('"');
+        return *this;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // READER
+
+    int JsonReader::peekChar()
+    {
+        if (m_pos == m_end) {
+            m_in.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+            m_end = static_cast<std::size_t>(m_in.gcount());
+            m_pos = 0;
+            if (m_end == 0)
+                return EOF;
+        }
+        return static_cast<unsigned char>(m_buffer[m_pos]);
+    }
+
+    int JsonReader::getChar()
+    {
+        int c = peekChar();
+        if (c != EOF)
+            m_pos++;
+        return c;
+    }
+
+    int JsonReader::skipSpaces()
+    {
+        int c = peekChar();
+        while (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            m_pos++;
+            c = peekChar();
+        }
+        return c;
+    }
+
+    static int hex_digit(int c) noexcept(true)
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool JsonReader::readString()
+    {
+        m_text.clear();
+        getChar();
+        while (true) {
+            int c = getChar();
+            if (c == EOF || c < 0x20)
+                return false;
+            if (c == '"')
+                return true;
+            if (c != '\\') {
+                m_text.push_back(static_cast<char>(c));
+                continue;
+            }
+
+            c = getChar();
+            switch (c) {
+                case '"': case '\\': case '/': m_text.push_back(static_cast<char>(c)); break;
+                case 'b': m_text.push_back('\b'); break;
+                case 'f': m_text.push_back('\f'); break;
+                case 'n': m_text.push_back('\n'); break;
+                case 'r': m_text.push_back('\r'); break;
+                case 't': m_text.push_back('\t'); break;
+                case 'u': {
+                    auto code = [this]() -> long
+                    {
+                        long v = 0;
+                        for (int i = 0; i < 4; i++) {
+                            int d = hex_digit(getChar());
+                            if (d < 0)
+                                return -1;
+                            v = v * 16 + d;
+                        }
+                        return v;
+                    };
+                    long cp = code();
+                    if (cp < 0)
+                        return false;
+                    if (cp >= 0xD800 && cp < 0xDC00) {
+                        if (getChar() != '\\' || getChar() != 'u')
+                            return false;
+                        long lo = code();
+                        if (lo < 0xDC00 || lo >= 0xE000)
+                            return false;
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    }
+                    // UTF-8
+                    if (cp < 0x80) {
+                        m_text.push_back(static_cast<char>(cp));
+                    } else if (cp < 0x800) {
+                        m_text.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                        m_text.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    } else if (cp < 0x10000) {
+                        m_text.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                        m_text.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        m_text.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    } else {
+                        m_text.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                        m_text.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                        m_text.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        m_text.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+    }
+
+    bool JsonReader::readLiteral(std::string_view literal)
+    {
+        for (char c: literal) {
+            if (getChar() != c)
+                return false;
+        }
+        return true;
+    }
+
+    JsonToken JsonReader::next()
+    {
+        if (m_failed)
+            return JsonToken_Error;
+        int c = skipSpaces();
+        if (m_done)
+            return c == EOF ? JsonToken_End : fail();
+
+        // After a value: a comma or the end of the container
+        bool comma = false;
+        if (!m_expectValue && !m_expectKey) {
+            if (c == ',') {
+                comma = true;
+                getChar();
+                c = skipSpaces();
+                (m_stack.back() == '{' ? m_expectKey : m_expectValue) = true;
+            } else if (c != '}' && c != ']') {
+                return fail();
+            }
+        }
+
+        if (c == '}' || c == ']') {
+            if (comma || m_stack.empty() || m_stack.back() != (c == '}' ? '{' : '[') || (c == '}' && m_expectValue))
+                return fail();
+            getChar();
+            m_stack.pop_back();
+            valueDone();
+            return c == '}' ? JsonToken_ObjectEnd : JsonToken_ArrayEnd;
+        }
+
+        if (m_expectKey) {
+            if (c != '"' || !readString() || skipSpaces() != ':')
+                return fail();
+            getChar();
+            m_expectKey = false;
+            m_expectValue = true;
+            return JsonToken_Key;
+        }
+
+        switch (c) {
+            case '{':
+                getChar();
+                m_stack.push_back('{');
+                m_expectValue = false;
+                m_expectKey = true;
+                return JsonToken_ObjectBegin;
+            case '[':
+                getChar();
+                m_stack.push_back('[');
+                m_expectValue = true;
+                return JsonToken_ArrayBegin;
+            case '"':
+                if (!readString())
+                    return fail();
+                valueDone();
+                return JsonToken_String;
+            case 't':
+            case 'f':
+                if (!readLiteral(c == 't' ? "true" : "false"))
+                    return fail();
+                m_bool = c == 't';
+                valueDone();
+                return JsonToken_Bool;
+            case 'n':
+                if (!readLiteral("null"))
+                    return fail();
+                valueDone();
+                return JsonToken_Null;
+            default:
+                break;
+        }
+
+        if (c != '-' && (c < '0' || c > '9'))
+            return fail();
+        m_text.clear();
+        while ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            m_text.push_back(static_cast<char>(getChar()));
+            c = peekChar();
+        }
+        double v;
+        auto r = std::from_chars(m_text.data(), m_text.data() + m_text.size(), v);
+        if (r.ec != std::errc() || r.ptr != m_text.data() + m_text.size())
+            return fail();
+        valueDone();
+        return JsonToken_Number;
+    }
+
+    void JsonReader::valueDone() noexcept(true)
+    {
+        m_expectValue = false;
+        m_expectKey = false;
+        if (m_stack.empty())
+            m_done = true;
+    }
+
+    bool JsonReader::skipValue(int open)
+    {
+        int depth = open;
+        do {
+            switch (next()) {
+                case JsonToken_ObjectBegin:
+                case JsonToken_ArrayBegin:
+                    depth++;
+                    break;
+                case JsonToken_ObjectEnd:
+                case JsonToken_ArrayEnd:
+                    depth--;
+                    break;
+                case JsonToken_End:
+                case JsonToken_Error:
+                    return false;
+                default:
+                    break;
+            }
+        } while (depth > 0);
+        return true;
+    }
+
+    double JsonReader::number() const noexcept(true)
+    {
+        double v = 0;
+        std::from_chars(m_text.data(), m_text.data() + m_text.size(), v);
+        return v;
+    }
+
+    uint64_t JsonReader::uinteger() const noexcept(true)
+    {
+        uint64_t v = 0;
+        auto r = std::from_chars(m_text.data(), m_text.data() + m_text.size(), v);
+        return r.ec == std::errc() && r.ptr == m_text.data() + m_text.size() ? v : 0;
+    }
+
+    bool JsonReader::hex(std::vector<std::byte>& out) const
+    {
+        if (m_text.size() % 2)
+            return false;
+        for (std::size_t i = 0; i < m_text.size(); i += 2) {
+            int hi = hex_digit(static_cast<unsigned char>(m_text[i]));
+            int lo = hex_digit(static_cast<unsigned char>(m_text[i + 1]));
+            if (hi < 0 || lo < 0)
+                return false;
+            out.push_back(static_cast<std::byte>(hi * 16 + lo));
+        }
+        return true;
+    }
+}
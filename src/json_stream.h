@@ -0,0 +1,177 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ImFlow
+{
+    /**
+     * @brief Streaming JSON writer
+     * @details Writes straight to the stream: commas and colons are inserted from a stack as deep as the nesting.
+     */
+    class JsonWriter
+    {
+    public:
+        /***/
+        explicit JsonWriter(std::ostream& out) noexcept(true)
+          : m_out(out)
+        {}
+
+        JsonWriter& beginObject();
+        JsonWriter& endObject();
+        JsonWriter& beginArray();
+        JsonWriter& endArray();
+
+        /**
+         * @brief <BR>Write the key of the next member
+         * @param k Key, escaped as needed
+         * @return Reference to this writer
+         */
+        JsonWriter& key(std::string_view k);
+
+        JsonWriter& string(std::string_view s);
+        JsonWriter& number(double v);
+        JsonWriter& integer(int64_t v);
+        JsonWriter& uinteger(uint64_t v);
+        JsonWriter& boolean(bool v);
+        JsonWriter& null();
+
+        /**
+         * @brief <BR>Write bytes as a hexadecimal string
+         * @param bytes Bytes to write
+         * @return Reference to this writer
+         */
+        JsonWriter& hex(std::span<const std::byte> bytes);
+
+        /**
+         * @brief <BR>Start the next value on a new line
+         * @details Keeps one entry per line in long arrays, so that the output diffs well.
+         * @return Reference to this writer
+         */
+        JsonWriter& lineBreak() noexcept(true)
+        { m_lineBreak = true; return *this; }
+
+    private:
+        void separator();
+        void quoted(std::string_view s);
+
+        std::ostream&     m_out;
+        std::vector<bool> m_first;
+        bool              m_afterKey = false;
+        bool              m_lineBreak = false;
+    };
+
+    /**
+     * @brief Token read by JsonReader
+     */
+    enum JsonToken
+    {
+        JsonToken_ObjectBegin,
+        JsonToken_ObjectEnd,
+        JsonToken_ArrayBegin,
+        JsonToken_ArrayEnd,
+        JsonToken_Key,
+        JsonToken_String,
+        JsonToken_Number,
+        JsonToken_Bool,
+        JsonToken_Null,
+        JsonToken_End,   // End of the document
+        JsonToken_Error  // Malformed input, every following call returns it too
+    };
+
+    /**
+     * @brief Streaming (pull) JSON reader
+     * @details Reads the stream through a fixed-size buffer and returns one token at a time: memory stays constant,
+     *          apart from the longest string and the nesting depth.
+     */
+    class JsonReader
+    {
+    public:
+        /***/
+        explicit JsonReader(std::istream& in)
+          : m_in(in), m_buffer(1 << 16)
+        {}
+
+        /**
+         * @brief <BR>Read the next token
+         * @return Type of the token. Its content is available until the next call
+         */
+        JsonToken next();
+
+        /**
+         * @brief <BR>Skip a value
+         * @details Call after a key to ignore its value, objects and arrays included.
+         * @param open Number of containers of the value already opened by the caller
+         * @return [FALSE] on malformed input
+         */
+        bool skipValue(int open = 0);
+
+        /**
+         * @brief <BR>Get the text of the last key or string
+         * @return Unescaped text, UTF-8
+         */
+        [[nodiscard]] constexpr std::string_view text() const noexcept(true) { return m_text; }
+
+        /**
+         * @brief <BR>Get the last number
+         * @return Value as a double
+         */
+        [[nodiscard]] double number() const noexcept(true);
+
+        /**
+         * @brief <BR>Get the last number as an unsigned integer
+         * @details Exact up to 2^64-1, unlike number().
+         * @return Value, 0 if it isn't a non-negative integer
+         */
+        [[nodiscard]] uint64_t uinteger() const noexcept(true);
+
+        /**
+         * @brief <BR>Get the last boolean
+         * @return Value of the token
+         */
+        [[nodiscard]] constexpr bool boolean() const noexcept(true) { return m_bool; }
+
+        /**
+         * @brief <BR>Decode the last string as hexadecimal bytes
+         * @param out Vector the bytes are appended to
+         * @return [FALSE] if the string isn't hexadecimal
+         */
+        bool hex(std::vector<std::byte>& out) const;
+
+        /**
+         * @brief <BR>Get failure status
+         * @return [TRUE] if malformed input was met
+         */
+        [[nodiscard]] constexpr bool failed() const noexcept(true) { return m_failed; }
+
+    private:
+        int peekChar();
+        int getChar();
+        int skipSpaces();
+        bool readString();
+        bool readLiteral(std::string_view literal);
+        void valueDone() noexcept(true);
+        JsonToken fail() noexcept(true) { m_failed = true; return JsonToken_Error; }
+
+        std::istream&     m_in;
+        std::vector<char> m_buffer;
+        std::size_t       m_pos = 0;
+        std::size_t       m_end = 0;
+
+        std::string       m_text;
+        bool              m_bool = false;
+        bool              m_failed = false;
+        bool              m_done = false;
+
+        // Open containers: '{' or '[', and whether a value or a key is expected next
+        std::vector<char> m_stack;
+        bool              m_expectValue = true;
+        bool              m_expectKey = false;
+    };
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <unordered_set>
+
+namespace ImFlow
+{
+    /**
+     * @brief Memory held by a graph, per category
+     * @details Estimates in bytes. Every byte is reported in exactly one category: the inline part of the strings and of
+     *          the function objects is moved out of the object that contains it. Heap memory owned by the values of the
+     *          pins (e.g. the buffer of a std::vector) and by the captures of the function objects isn't visible.
+     */
+    struct MemoryStats
+    {
+        std::size_t nodes = 0;      // Node objects, with their control block
+        std::size_t pins = 0;       // Pin objects, with their control block
+        std::size_t links = 0;      // Link objects, with their control block
+        std::size_t styles = 0;     // Node and pin styles, a shared style is counted once
+        std::size_t strings = 0;    // Titles and names
+        std::size_t functions = 0;  // Behaviours, renderers, filters and processors
+        std::size_t evaluation = 0; // Memoization caches, snapshots, delays, asynchronous states and streams
+        std::size_t graph = 0;      // Containers of the handler and adjacency lists
+        std::size_t drawCache = 0;  // Vertex, index and command buffers of the editor's windows
+
+        std::size_t nodeCount = 0;
+        std::size_t pinCount = 0;
+        std::size_t linkCount = 0;
+
+        [[nodiscard]] constexpr std::size_t total() const noexcept(true)
+        { return nodes + pins + links + styles + strings + functions + evaluation + graph + drawCache; }
+    };
+
+    /**
+     * @brief Walks a graph once, remembering the shared objects already counted
+     */
+    struct MemoryWalk
+    {
+        MemoryStats&                    stats;
+        std::unordered_set<const void*> shared;
+
+        /**
+         * @brief <BR>Check whether a shared object is met for the first time
+         * @param p Address of the object
+         * @return [TRUE] if it must be counted
+         */
+        bool first(const void* p) { return p && shared.insert(p).second; }
+    };
+
+    /**
+     * @brief <BR>Estimate the control block of std::allocate_shared
+     * @return Size of the reference counters and of the vtable pointer
+     */
+    constexpr std::size_t shared_block_bytes() noexcept(true)
+    { return 2 * sizeof(long) + sizeof(void*); }
+
+    /**
+     * @brief <BR>Get the heap buffer of a string
+     * @param s String to measure
+     * @return Bytes allocated, 0 while the small string optimization holds it
+     */
+    inline std::size_t string_heap_bytes(const std::string& s) noexcept(true)
+    {
+        static const std::size_t inlineCapacity = std::string().capacity();
+        return s.capacity() > inlineCapacity ? s.capacity() + 1 : 0;
+    }
+
+    /**
+     * @brief <BR>Get the buffer of a vector
+     * @param v Vector to measure
+     * @return Bytes reserved for the elements
+     */
+    template<class V> constexpr std::size_t vector_bytes(const V& v) noexcept(true)
+    { return v.capacity() * sizeof(typename V::value_type); }
+}
@@ -0,0 +1,119 @@
+#include "ImNodeFlow.h"
+#include "node_record.h"
+#include "node_registry.h"
+
+namespace ImFlow
+{
+    /**
+     * @brief Fields of a node snapshot, parsed before anything is created
+     */
+    struct NodeRecordView
+    {
+        NodeUID                    uid = 0;
+        uint32_t                   type = NodeRegistry::unknown;
+        ImVec2                     pos;
+        std::span<const std::byte> title;
+        std::vector<std::pair<PinUID, std::span<const std::byte>>> defaults;
+        std::span<const std::byte> state;
+    };
+
+    static bool parse_node_record(RecordReader& in, NodeRecordView& v)
+    {
+        v.uid = static_cast<NodeUID>(in.get<uint64_t>());
+        v.type = in.get<uint32_t>();
+        v.pos = in.get<ImVec2>();
+        v.title = in.block();
+        auto count = in.get<uint32_t>();
+        for (uint32_t i = 0; i < count && in.ok; i++) {
+            auto pin = static_cast<PinUID>(in.get<uint64_t>());
+            v.defaults.emplace_back(pin, in.block());
+        }
+        v.state = in.block();
+        return in.ok;
+    }
+
+    static void apply_node_fields(const NodeRegistry& registry, BaseNode& node, const NodeRecordView& v)
+    {
+        node.setTitle(std::string(reinterpret_cast<const char*>(v.title.data()), v.title.size()));
+        for (auto &d: v.defaults) {
+            if (Pin* p = record_pin(node, d.first, false))
+                (void)p->setDefaultBytes(d.second);
+        }
+        const NodeType* t = registry.find(v.type);
+        if (t && t->loadState && !v.state.empty())
+            (void)t->loadState(node, v.state);
+    }
+
+    Pin* record_pin(BaseNode& node, uint64_t uid, bool output) noexcept(true)
+    {
+        for (auto &p: output ? node.getOuts() : node.getIns()) {
+            if (p->getUid() == uid)
+                return p.get();
+        }
+        return nullptr;
+    }
+
+    void write_node_record(const NodeRegistry& registry, BaseNode& node, std::vector<std::byte>& out)
+    {
+        record_put(out, static_cast<uint64_t>(node.getUID()));
+        uint32_t type = registry.typeOf(node);
+        record_put(out, type);
+        record_put(out, node.getPos());
+        std::string_view title = node.getName();
+        record_put_block(out, std::as_bytes(std::span(title.data(), title.size())));
+
+        std::size_t countAt = out.size();
+        uint32_t count = 0;
+        record_put(out, count);
+        for (auto &p: node.getIns()) {
+            std::span<const std::byte> d = p->defaultBytes();
+            if (d.empty())
+                continue;
+            record_put(out, static_cast<uint64_t>(p->getUid()));
+            record_put_block(out, d);
+            count++;
+        }
+        std::memcpy(out.data() + countAt, &count, sizeof(count));
+
+        // State is appended in place, then its size is patched
+        std::size_t stateAt = out.size();
+        record_put(out, uint32_t(0));
+        const NodeType* t = registry.find(type);
+        if (t && t->saveState) {
+            t->saveState(node, out);
+            auto size = static_cast<uint32_t>(out.size() - stateAt - sizeof(uint32_t));
+            std::memcpy(out.data() + stateAt, &size, sizeof(size));
+        }
+    }
+
+    std::shared_ptr<BaseNode> read_node_record(const NodeRegistry& registry, ImNodeFlow& inf, RecordReader& in)
+    {
+        NodeRecordView v;
+        if (!parse_node_record(in, v))
+            return nullptr;
+
+        // Created with its UID, so that the observers never see another one
+        if (!inf.setNextNodeUID(v.uid))
+            return nullptr;
+        std::shared_ptr<BaseNode> n = registry.create(inf, v.type, v.pos);
+        inf.setNextNodeUID(0);
+        if (!n)
+            return nullptr;
+        if (n->getUID() != v.uid) {
+            inf.removeNode(n->getUID());
+            return nullptr;
+        }
+        apply_node_fields(registry, *n, v);
+        return n;
+    }
+
+    bool apply_node_record(const NodeRegistry& registry, BaseNode& node, RecordReader& in)
+    {
+        NodeRecordView v;
+        if (!parse_node_record(in, v) || registry.typeOf(node) != v.type)
+            return false;
+        node.setPos(v.pos);
+        apply_node_fields(registry, node, v);
+        return true;
+    }
+}
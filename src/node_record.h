@@ -0,0 +1,109 @@
+#pragma once
+
+#include <span>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ImFlow
+{
+    class Pin;
+    class BaseNode;
+    class ImNodeFlow;
+    class NodeRegistry;
+
+    /**
+     * @brief <BR>Append the bytes of a trivially copyable value
+     * @param out Vector the bytes are appended to
+     * @param v Value to write
+     */
+    template<class T> void record_put(std::vector<std::byte>& out, const T& v)
+    {
+        std::size_t at = out.size();
+        out.resize(at + sizeof(T));
+        std::memcpy(out.data() + at, &v, sizeof(T));
+    }
+
+    /**
+     * @brief <BR>Append a block of bytes, prefixed with its 32-bit size
+     * @param out Vector the bytes are appended to
+     * @param bytes Bytes to write
+     */
+    inline void record_put_block(std::vector<std::byte>& out, std::span<const std::byte> bytes)
+    {
+        record_put(out, static_cast<uint32_t>(bytes.size()));
+        out.insert(out.end(), bytes.begin(), bytes.end());
+    }
+
+    /**
+     * @brief Bounds-checked reader of the values written by record_put() and record_put_block()
+     */
+    struct RecordReader
+    {
+        std::span<const std::byte> bytes;
+        std::size_t                pos = 0;
+        bool                       ok = true;
+
+        template<class T> T get() noexcept(true)
+        {
+            T v{};
+            if (bytes.size() - pos < sizeof(T)) {
+                ok = false;
+                return v;
+            }
+            std::memcpy(&v, bytes.data() + pos, sizeof(T));
+            pos += sizeof(T);
+            return v;
+        }
+
+        std::span<const std::byte> block() noexcept(true)
+        {
+            auto size = get<uint32_t>();
+            if (bytes.size() - pos < size) {
+                ok = false;
+                return {};
+            }
+            pos += size;
+            return bytes.subspan(pos - size, size);
+        }
+    };
+
+    /**
+     * @brief <BR>Append a snapshot of a node
+     * @details UID, type ID, position, title, input defaults and state. Links aren't part of it.
+     * @param registry Registry giving the type and state of the node
+     * @param node Node to write
+     * @param out Vector the bytes are appended to
+     */
+    void write_node_record(const NodeRegistry& registry, BaseNode& node, std::vector<std::byte>& out);
+
+    /**
+     * @brief <BR>Recreate a node from its snapshot, with its UID
+     * @param registry Registry creating the node
+     * @param inf Handler to add the node to
+     * @param in Reader positioned on the snapshot, left after it
+     * @return Shared pointer to the node, nullptr if the snapshot is invalid, its type unregistered or its UID taken
+     */
+    std::shared_ptr<BaseNode> read_node_record(const NodeRegistry& registry, ImNodeFlow& inf, RecordReader& in);
+
+    /**
+     * @brief <BR>Apply a snapshot to an existing node
+     * @details Position, title, input defaults and state. The UID of the snapshot is ignored.
+     * @param registry Registry giving the type of the node
+     * @param node Node to update
+     * @param in Reader positioned on the snapshot, left after it
+     * @return [FALSE] if the snapshot is invalid or of another type
+     */
+    bool apply_node_record(const NodeRegistry& registry, BaseNode& node, RecordReader& in);
+
+    /**
+     * @brief <BR>Find a static pin of a node by UID
+     * @param node Node to search
+     * @param uid UID of the pin
+     * @param output [TRUE] to search the outputs, [FALSE] the inputs
+     * @return Pointer to the pin, nullptr if there's none
+     */
+    Pin* record_pin(BaseNode& node, uint64_t uid, bool output) noexcept(true);
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <span>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <concepts>
+#include <algorithm>
+#include <typeindex>
+#include <functional>
+#include <unordered_map>
+#include <imgui.h>
+#include "ImNodeFlow.h"
+#include "json_stream.h"
+
+namespace ImFlow
+{
+    /**
+     * @brief Node with its own state (de)serialization
+     * @details Detected by NodeRegistry::add(). The state is whatever the pins don't hold: settings edited in draw(), buffers, ...
+     */
+    template<class T> concept NodeWithState = requires(const T& c, T& m, std::vector<std::byte>& out, std::span<const std::byte> in)
+    {
+        c.saveState(out);
+        { m.loadState(in) } -> std::convertible_to<bool>;
+    };
+
+    /**
+     * @brief Node with its own state written as JSON
+     * @details Detected by NodeRegistry::add(). readJson() must consume exactly the value written by writeJson().
+     */
+    template<class T> concept NodeWithJsonState = requires(const T& c, T& m, JsonWriter& w, JsonReader& r)
+    {
+        c.writeJson(w);
+        { m.readJson(r) } -> std::convertible_to<bool>;
+    };
+
+    /**
+     * @brief Registered node type
+     */
+    struct NodeType
+    {
+        uint32_t    id = 0;
+        std::string name;
+
+        /// @brief Create the node and add it to the handler
+        std::function<std::shared_ptr<BaseNode>(ImNodeFlow& inf, const ImVec2& pos)> create;
+        /// @brief Append the state of the node. Optional
+        std::function<void(const BaseNode& node, std::vector<std::byte>& out)> saveState;
+        /// @brief Restore the state of the node, return [FALSE] if it is invalid. Optional
+        std::function<bool(BaseNode& node, std::span<const std::byte> in)> loadState;
+        /// @brief Write the state of the node as one JSON value. Optional, the binary state is written in hexadecimal otherwise
+        std::function<void(const BaseNode& node, JsonWriter& out)> writeJson;
+        /// @brief Read the value written by writeJson, return [FALSE] if it is invalid. Optional
+        std::function<bool(BaseNode& node, JsonReader& in)> readJson;
+    };
+
+    /**
+     * @brief Maps stable type IDs to node factories
+     * @details Lookups by ID and by C++ type are hash lookups on integers, never on strings.
+     *          Fill it at startup (see IMFLOW_REGISTER_NODE): it isn't thread-safe while being modified.
+     */
+    class NodeRegistry
+    {
+    public:
+        /// @brief Type ID of the nodes that aren't registered
+        static constexpr uint32_t unknown = UINT32_MAX;
+
+        /**
+         * @brief <BR>Register a default-constructible node type
+         * @details Its saveState()/loadState() and writeJson()/readJson() members are used if it has them (see NodeWithState and NodeWithJsonState).
+         * @tparam T Derived class of <BaseNode> to register
+         * @param id Stable type ID, stored in files
+         * @param name Name, for display and interchange formats
+         * @return Reference to this registry
+         */
+        template<class T> NodeRegistry& add(uint32_t id, std::string name = {});
+
+        /**
+         * @brief <BR>Register a node type with a custom factory
+         * @details Registering a type again replaces it. An ID belongs to a single type: registering it for another type asserts,
+         *          and unregisters the previous type in release builds.
+         * @param type C++ type of the nodes created by the factory
+         * @param t Type ID, name, factory and state (de)serializers
+         * @return Reference to this registry
+         */
+        NodeRegistry& add(std::type_index type, NodeType t)
+        {
+            assert(t.id != unknown && "Reserved type ID!");
+            auto prev = m_ids.find(type);
+            if (prev != m_ids.end() && prev->second != t.id)
+                m_types.erase(prev->second);
+            // Nodes of another type registered with the same ID would be saved and cloned as this one: that type loses the ID
+            auto owner = std::find_if(m_ids.begin(), m_ids.end(), [&](const auto& e) { return e.second == t.id && e.first != type; });
+            assert(owner == m_ids.end() && "Type ID already registered by another type!");
+            if (owner != m_ids.end())
+                m_ids.erase(owner);
+            m_ids[type] = t.id;
+            m_types[t.id] = std::move(t);
+            return *this;
+        }
+
+        /**
+         * @brief <BR>Find a type by ID
+         * @param id Type ID
+         * @return Pointer to the type, nullptr if unregistered
+         */
+        [[nodiscard]] const NodeType* find(uint32_t id) const noexcept(true)
+        {
+            auto it = m_types.find(id);
+            return it != m_types.end() ? &it->second : nullptr;
+        }
+
+        /**
+         * @brief <BR>Find the type of a node
+         * @param node Node of any registered type
+         * @return Pointer to the type, nullptr if unregistered
+         */
+        [[nodiscard]] const NodeType* find(const BaseNode& node) const noexcept(true);
+
+        /**
+         * @brief <BR>Get the type ID of a node
+         * @param node Node of any registered type
+         * @return Type ID, NodeRegistry::unknown if unregistered
+         */
+        [[nodiscard]] uint32_t typeOf(const BaseNode& node) const noexcept(true)
+        {
+            const NodeType* t = find(node);
+            return t ? t->id : unknown;
+        }
+
+        /**
+         * @brief <BR>Create a node by type ID
+         * @param inf Handler to add the node to
+         * @param id Type ID
+         * @param pos Position in grid coordinates
+         * @return Shared pointer to the node, nullptr if the type is unregistered
+         */
+        std::shared_ptr<BaseNode> create(ImNodeFlow& inf, uint32_t id, const ImVec2& pos) const
+        {
+            const NodeType* t = find(id);
+            return t ? t->create(inf, pos) : nullptr;
+        }
+
+        /**
+         * @brief <BR>Create a copy of a node
+         * @details The copy is created by the factory of the prototype's type, then takes its title, styles (shared),
+         *          input defaults and state. Links aren't copied.
+         * @param inf Handler to add the copy to
+         * @param prototype Node to copy, of a registered type
+         * @param pos Position of the copy in grid coordinates
+         * @return Shared pointer to the copy, nullptr if the type is unregistered
+         */
+        std::shared_ptr<BaseNode> clone(ImNodeFlow& inf, const BaseNode& prototype, const ImVec2& pos) const;
+
+        /**
+         * @brief <BR>Get number of registered types
+         * @return Number of types
+         */
+        [[nodiscard]] std::size_t size() const noexcept(true)
+        { return m_types.size(); }
+
+    private:
+        std::unordered_map<uint32_t, NodeType>        m_types;
+        std::unordered_map<std::type_index, uint32_t> m_ids;
+    };
+
+    template<class T>
+    NodeRegistry& NodeRegistry::add(uint32_t id, std::string name)
+    {
+        static_assert(std::is_base_of<BaseNode, T>::value, "Registered type is not a subclass of BaseNode!");
+
+        NodeType t;
+        t.id = id;
+        t.name = std::move(name);
+        t.create = [](ImNodeFlow& inf, const ImVec2& pos) -> std::shared_ptr<BaseNode> { return inf.addNode<T>(pos); };
+        if constexpr (NodeWithState<T>)
+        {
+            t.saveState = [](const BaseNode& node, std::vector<std::byte>& out) { static_cast<const T&>(node).saveState(out); };
+            t.loadState = [](BaseNode& node, std::span<const std::byte> in) -> bool { return static_cast<T&>(node).loadState(in); };
+        }
+        if constexpr (NodeWithJsonState<T>)
+        {
+            t.writeJson = [](const BaseNode& node, JsonWriter& out) { static_cast<const T&>(node).writeJson(out); };
+            t.readJson = [](BaseNode& node, JsonReader& in) -> bool { return static_cast<T&>(node).readJson(in); };
+        }
+        return add(std::type_index(typeid(T)), std::move(t));
+    }
+}
+
+#define IMFLOW_REGISTRY_CONCAT_(a, b) a##b
+#define IMFLOW_REGISTRY_CONCAT(a, b) IMFLOW_REGISTRY_CONCAT_(a, b)
+/// @brief Register a default-constructible node type in node_registry() during static initialization. Use at namespace scope
+#define IMFLOW_REGISTER_NODE(T, id) \
+    static const bool IMFLOW_REGISTRY_CONCAT(imflow_registered_, __LINE__) = (::ImFlow::node_registry().add<T>(id, #T), true)
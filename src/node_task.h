@@ -0,0 +1,318 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <algorithm>
+#include <coroutine>
+#include <functional>
+#include <stop_token>
+#include "thread_pool.h"
+#include "allocator.h"
+
+namespace ImFlow
+{
+    class TaskScheduler;
+
+    /**
+     * @brief Base class for the awaitables parked in the TaskScheduler
+     * @details Unregisters itself when the coroutine holding it is destroyed while suspended.
+     */
+    class TaskWaiter
+    {
+    public:
+        TaskWaiter() = default;
+        TaskWaiter(const TaskWaiter&) = delete;
+        TaskWaiter& operator=(const TaskWaiter&) = delete;
+        /***/
+        virtual ~TaskWaiter();
+
+        /**
+         * @brief <BR>Polled by the scheduler on each tick
+         * @return [TRUE] if the coroutine can be resumed
+         */
+        [[nodiscard]] virtual bool ready() noexcept(true) = 0;
+
+    protected:
+        /**
+         * @brief <BR>Park the coroutine in the scheduler of its promise
+         */
+        template<class P> void park(std::coroutine_handle<P> h) noexcept(true);
+
+    private:
+        friend class TaskScheduler;
+        TaskScheduler*          m_scheduler = nullptr;
+        std::coroutine_handle<> m_handle;
+    };
+
+    /**
+     * @brief Resumes suspended node coroutines
+     * @details Single threaded: owned by the handler and ticked on the UI thread at the start of each update.
+     *          A waiting coroutine only costs its frame and a pointer in the list.
+     */
+    class TaskScheduler
+    {
+    public:
+        TaskScheduler() = default;
+        TaskScheduler(const TaskScheduler&) = delete;
+        TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+        /**
+         * @brief <BR>Resume every coroutine whose awaitable is ready
+         * @details Coroutines suspending again during the tick are only polled on the next one.
+         */
+        void tick() noexcept(true)
+        {
+            std::swap(m_waiting, m_polling);
+            for (size_t i = 0; i < m_polling.size(); i++)
+            {
+                TaskWaiter* w = m_polling[i];
+                if (!w)
+                    continue;
+                if (!w->ready())
+                {
+                    m_waiting.push_back(w);
+                    continue;
+                }
+                m_polling[i] = nullptr;
+                w->m_scheduler = nullptr;
+                w->m_handle.resume();
+            }
+            m_polling.clear();
+        }
+
+        /**
+         * @brief <BR>Get number of suspended coroutines
+         * @return Number of coroutines waiting to be resumed
+         */
+        [[nodiscard]] size_t size() const noexcept(true)
+        { return m_waiting.size() + std::count_if(m_polling.begin(), m_polling.end(), [](TaskWaiter* w) { return w != nullptr; }); }
+
+    private:
+        friend class TaskWaiter;
+
+        void add(TaskWaiter* w) noexcept(true)
+        { w->m_scheduler = this; m_waiting.push_back(w); }
+
+        void remove(TaskWaiter* w) noexcept(true)
+        {
+            // A coroutine destroyed during a tick (from another one being resumed) may still be in the polling list
+            auto it = std::find(m_waiting.begin(), m_waiting.end(), w);
+            if (it != m_waiting.end())
+            {
+                *it = m_waiting.back();
+                m_waiting.pop_back();
+            }
+            std::replace(m_polling.begin(), m_polling.end(), w, static_cast<TaskWaiter*>(nullptr));
+        }
+
+        std::vector<TaskWaiter*, TaggedAllocator<TaskWaiter*, AllocTag_Evaluation>> m_waiting;
+        std::vector<TaskWaiter*, TaggedAllocator<TaskWaiter*, AllocTag_Evaluation>> m_polling;
+    };
+
+    inline TaskWaiter::~TaskWaiter()
+    {
+        if (m_scheduler)
+            m_scheduler->remove(this);
+    }
+
+    /**
+     * @brief Promise data shared by every Task
+     */
+    struct TaskPromiseBase
+    {
+        TaskScheduler*          scheduler = nullptr;
+        std::coroutine_handle<> continuation;
+
+        /**
+         * @brief Resumes the awaiting Task, if any, when the coroutine completes
+         */
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept(true) { return false; }
+            template<class P> std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept(true)
+            {
+                std::coroutine_handle<> c = h.promise().continuation;
+                return c ? c : std::noop_coroutine();
+            }
+            void await_resume() noexcept(true) {}
+        };
+
+        std::suspend_always initial_suspend() noexcept(true) { return {}; }
+        FinalAwaiter final_suspend() noexcept(true) { return {}; }
+        void unhandled_exception() noexcept(true) { std::terminate(); }
+
+        // Coroutine frames are restarted whenever the inputs change: they are accounted to the evaluation
+        static void* operator new(std::size_t bytes)
+        { return tagged_alloc(bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__, AllocTag_Evaluation); }
+        static void operator delete(void* p, std::size_t bytes) noexcept(true)
+        { tagged_free(p, bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__, AllocTag_Evaluation); }
+    };
+
+    template<class P> void TaskWaiter::park(std::coroutine_handle<P> h) noexcept(true)
+    {
+        m_handle = h;
+        h.promise().scheduler->add(this);
+    }
+
+    /**
+     * @brief Coroutine behaviour of a node
+     * @details Lazily started. Can co_await other Tasks, nextFrame(), waitUntil(), inputReady() and background().
+     *          Destroying the Task destroys the suspended coroutine with it.
+     * @tparam T Type of the value returned with co_return
+     */
+    template<class T> class Task
+    {
+    public:
+        struct promise_type : TaskPromiseBase
+        {
+            std::optional<T> result;
+
+            Task get_return_object() noexcept(true) { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            void return_value(T v) noexcept(true) { result.emplace(std::move(v)); }
+        };
+
+        /***/
+        Task(Task&& other) noexcept(true) : m_handle(std::exchange(other.m_handle, nullptr)) {}
+        /***/
+        Task& operator=(Task&& other) noexcept(true)
+        {
+            if (this != &other)
+            {
+                if (m_handle) m_handle.destroy();
+                m_handle = std::exchange(other.m_handle, nullptr);
+            }
+            return *this;
+        }
+        /***/
+        ~Task() { if (m_handle) m_handle.destroy(); }
+
+        /**
+         * @brief <BR>Run the coroutine until its first suspension
+         * @param scheduler Scheduler in charge of resuming it
+         */
+        void start(TaskScheduler& scheduler) noexcept(true)
+        {
+            m_handle.promise().scheduler = &scheduler;
+            m_handle.resume();
+        }
+
+        /**
+         * @brief <BR>Get completion status
+         * @return [TRUE] once the coroutine returned its value
+         */
+        [[nodiscard]] bool done() const noexcept(true)
+        { return m_handle && m_handle.done(); }
+
+        /**
+         * @brief <BR>Move out the returned value
+         * @return Value returned by the coroutine
+         */
+        T take() noexcept(true)
+        { return std::move(*m_handle.promise().result); }
+
+        // Awaiting a Task runs it inside the awaiting one, on the same scheduler
+        bool await_ready() noexcept(true) { return done(); }
+        template<class P> std::coroutine_handle<> await_suspend(std::coroutine_handle<P> awaiting) noexcept(true)
+        {
+            m_handle.promise().scheduler = awaiting.promise().scheduler;
+            m_handle.promise().continuation = awaiting;
+            return m_handle;
+        }
+        T await_resume() noexcept(true) { return take(); }
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> h) noexcept(true) : m_handle(h) {}
+
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+    /**
+     * @brief Suspends the coroutine until the next tick
+     */
+    struct NextFrameAwaiter : TaskWaiter
+    {
+        bool await_ready() noexcept(true) { return false; }
+        template<class P> void await_suspend(std::coroutine_handle<P> h) noexcept(true) { park(h); }
+        void await_resume() noexcept(true) {}
+        bool ready() noexcept(true) override { return true; }
+    };
+
+    /**
+     * @brief Suspends the coroutine until a condition holds
+     */
+    struct WaitUntilAwaiter : TaskWaiter
+    {
+        explicit WaitUntilAwaiter(std::function<bool()> condition) noexcept(true) : condition(std::move(condition)) {}
+
+        bool await_ready() noexcept(true) { return condition(); }
+        template<class P> void await_suspend(std::coroutine_handle<P> h) noexcept(true) { park(h); }
+        void await_resume() noexcept(true) {}
+        bool ready() noexcept(true) override { return condition(); }
+
+        std::function<bool()> condition;
+    };
+
+    /**
+     * @brief Runs a function on a ThreadPool and suspends the coroutine until its result is available
+     * @details If the coroutine is destroyed in the meantime the function is asked to stop and its result dropped.
+     * @tparam R Type returned by the function
+     */
+    template<class R> struct BackgroundAwaiter : TaskWaiter
+    {
+        struct State
+        {
+            std::stop_source  stop;
+            std::optional<R>  result;
+            std::atomic<bool> done = false;
+        };
+
+        BackgroundAwaiter(ThreadPool& pool, std::function<R(std::stop_token)> fn) noexcept(true)
+          : pool(pool), fn(std::move(fn)), state(std::allocate_shared<State>(TaggedAllocator<State, AllocTag_Evaluation>{}))
+        {}
+        ~BackgroundAwaiter() override { state->stop.request_stop(); }
+
+        bool await_ready() noexcept(true) { return false; }
+        template<class P> void await_suspend(std::coroutine_handle<P> h) noexcept(true)
+        {
+            pool.submit([s = state, f = std::move(fn)]()
+            {
+                if (!s->stop.stop_requested())
+                    s->result.emplace(f(s->stop.get_token()));
+                s->done.store(true, std::memory_order_release);
+            });
+            park(h);
+        }
+        R await_resume() noexcept(true) { return std::move(*state->result); }
+        bool ready() noexcept(true) override { return state->done.load(std::memory_order_acquire); }
+
+        ThreadPool&                       pool;
+        std::function<R(std::stop_token)> fn;
+        std::shared_ptr<State>            state;
+    };
+
+    /**
+     * @brief <BR>Suspend a node coroutine until the next frame
+     */
+    inline NextFrameAwaiter nextFrame() noexcept(true)
+    { return {}; }
+
+    /**
+     * @brief <BR>Suspend a node coroutine until a condition holds
+     * @param condition Function or lambda expression polled once per frame
+     */
+    inline WaitUntilAwaiter waitUntil(std::function<bool()> condition) noexcept(true)
+    { return WaitUntilAwaiter(std::move(condition)); }
+
+    /**
+     * @brief <BR>Run a blocking function in the background and suspend a node coroutine until it returns
+     * @param pool Pool the function runs on (see ImNodeFlow::getExecutor())
+     * @param fn Function or lambda expression. Must only use data it owns
+     */
+    template<class F, class R = std::invoke_result_t<F, std::stop_token>>
+    BackgroundAwaiter<R> background(ThreadPool& pool, F&& fn) noexcept(true)
+    { return BackgroundAwaiter<R>(pool, std::function<R(std::stop_token)>(std::forward<F>(fn))); }
+}
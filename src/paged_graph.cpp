@@ -0,0 +1,396 @@
+#include "ImNodeFlow.h"
+#include "paged_graph.h"
+#include "node_record.h"
+
+#include <filesystem>
+
+namespace ImFlow
+{
+    static bool seek_file(std::FILE* f, uint64_t offset) noexcept(true)
+    {
+#ifdef _WIN32
+        return _fseeki64(f, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+        return fseeko(f, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+
+    /**
+     * @brief Unregisters the observers of a handler for its lifetime: paging isn't an edit
+     */
+    struct PagingMute
+    {
+        ImNodeFlow&                 inf;
+        std::vector<GraphObserver*> observers;
+
+        explicit PagingMute(ImNodeFlow& f)
+          : inf(f), observers(f.getObservers())
+        { for (auto* o: observers) inf.removeObserver(o); }
+
+        ~PagingMute()
+        { for (auto* o: observers) inf.addObserver(o); }
+    };
+
+    PagedGraph::PagedGraph(ImNodeFlow& inf, std::string path, const NodeRegistry& registry)
+      : m_inf(inf), m_registry(registry), m_path(std::move(path))
+    {
+        m_file = std::fopen(m_path.c_str(), "w+b");
+        m_inf.setReservedUIDs([this](NodeUID uid) { return m_pages.count(uid) != 0; });
+        m_inf.setPagedGraph(this);
+    }
+
+    PagedGraph::~PagedGraph()
+    {
+        m_inf.setReservedUIDs({});
+        m_inf.setPagedGraph(nullptr);
+        if (m_file) {
+            std::fclose(m_file);
+            std::error_code ec;
+            std::filesystem::remove(m_path, ec);
+        }
+    }
+
+    void PagedGraph::setTileSize(float size) noexcept(true)
+    {
+        if (!m_pages.empty() || size <= 0.f)
+            return;
+        m_tileSize = size;
+        m_window = {};
+    }
+
+    uint64_t PagedGraph::tileOf(const ImVec2& pos) const noexcept(true)
+    {
+        auto x = static_cast<int32_t>(std::floor(pos.x / m_tileSize));
+        auto y = static_cast<int32_t>(std::floor(pos.y / m_tileSize));
+        return (uint64_t(uint32_t(x)) << 32) | uint32_t(y);
+    }
+
+    int PagedGraph::tileDistance(uint64_t tile) const noexcept(true)
+    {
+        auto x = static_cast<int32_t>(uint32_t(tile >> 32));
+        auto y = static_cast<int32_t>(uint32_t(tile));
+        int dx = std::max({ m_window.x0 - x, x - m_window.x1, 0 });
+        int dy = std::max({ m_window.y0 - y, y - m_window.y1, 0 });
+        return std::max(dx, dy);
+    }
+
+    bool PagedGraph::evictable(BaseNode& node) const noexcept(true)
+    {
+        // Nothing in memory may read from it
+        return node.downstream().empty() && !node.isSink() && node.m_dynamicIns.empty() && node.m_dynamicOuts.empty() &&
+               tileDistance(tileOf(node.getPos())) > 0 && m_registry.find(node);
+    }
+
+    void PagedGraph::update()
+    {
+        ContainedContext& c = m_inf.getContext();
+        ImVec2 min = ImVec2(0.f, 0.f) - m_inf.getScroll();
+        update(min, min + c.size() / c.scale());
+    }
+
+    void PagedGraph::update(const ImVec2& min, const ImVec2& max)
+    {
+        if (!m_file)
+            return;
+
+        TileRect w;
+        w.x0 = static_cast<int32_t>(std::floor(min.x / m_tileSize)) - m_margin;
+        w.y0 = static_cast<int32_t>(std::floor(min.y / m_tileSize)) - m_margin;
+        w.x1 = static_cast<int32_t>(std::floor(max.x / m_tileSize)) + m_margin;
+        w.y1 = static_cast<int32_t>(std::floor(max.y / m_tileSize)) + m_margin;
+        bool moved = w != m_window;
+        m_window = w;
+
+        if (moved && !m_tiles.empty()) {
+            // Page in the tiles entering the window, in file order
+            std::vector<NodeUID> entering;
+            auto take = [&](std::vector<NodeUID>& list)
+            {
+                for (NodeUID uid: list) {
+                    if (m_pages.count(uid))
+                        entering.push_back(uid);
+                }
+            };
+            uint64_t area = uint64_t(w.x1 - w.x0 + 1) * uint64_t(w.y1 - w.y0 + 1);
+            if (area < m_tiles.size()) {
+                for (int32_t x = w.x0; x <= w.x1; x++) {
+                    for (int32_t y = w.y0; y <= w.y1; y++) {
+                        auto it = m_tiles.find((uint64_t(uint32_t(x)) << 32) | uint32_t(y));
+                        if (it == m_tiles.end())
+                            continue;
+                        take(it->second);
+                        m_tiles.erase(it);
+                    }
+                }
+            } else {
+                for (auto it = m_tiles.begin(); it != m_tiles.end();) {
+                    if (tileDistance(it->first) > 0) {
+                        ++it;
+                        continue;
+                    }
+                    take(it->second);
+                    it = m_tiles.erase(it);
+                }
+            }
+            std::sort(entering.begin(), entering.end(), [this](NodeUID a, NodeUID b) { return m_pages[a].offset < m_pages[b].offset; });
+            for (NodeUID uid: entering) { materialize(uid); }
+        }
+
+        if (moved || m_inf.getNodes().size() != m_lastCount)
+            enforceBudget();
+        m_lastCount = m_inf.getNodes().size();
+
+        if ((m_pages.empty() && m_fileSize) || (m_garbage > (std::size_t(16) << 20) && m_garbage * 2 > m_fileSize))
+            compact();
+    }
+
+    void PagedGraph::enforceBudget()
+    {
+        struct Candidate
+        {
+            int         distance;
+            std::size_t bytes;
+            NodeUID     uid;
+        };
+        auto nearer = [](const Candidate& a, const Candidate& b) { return a.distance < b.distance; };
+
+        // One walk, so that shared styles are counted once
+        MemoryStats s;
+        MemoryWalk walk{ s, {} };
+        std::vector<Candidate> heap;
+        for (auto &n: m_inf.getNodes()) {
+            std::size_t before = s.total();
+            n.second->memoryUsage(walk);
+            if (evictable(*n.second))
+                heap.push_back({ tileDistance(tileOf(n.second->getPos())), s.total() - before, n.first });
+        }
+        m_residentBytes = s.total();
+        if (m_residentBytes <= m_budget || heap.empty())
+            return;
+
+        PagingMute mute(m_inf);
+        std::make_heap(heap.begin(), heap.end(), nearer);
+        auto& nodes = m_inf.getNodes();
+        std::vector<BaseNode*> feeders;
+        while (m_residentBytes > m_budget && !heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), nearer);
+            Candidate c = heap.back();
+            heap.pop_back();
+            // Nodes feeding several paged-out nodes are listed more than once
+            auto it = nodes.find(c.uid);
+            if (it == nodes.end() || !evictable(*it->second))
+                continue;
+
+            feeders.assign(it->second->upstream().begin(), it->second->upstream().end());
+            if (!pageOut(*it->second))
+                break;
+            m_residentBytes -= std::min(c.bytes, m_residentBytes);
+
+            // Its feeders may now have nothing in memory reading from them
+            for (BaseNode* f: feeders) {
+                if (!evictable(*f))
+                    continue;
+                MemoryStats fs;
+                MemoryWalk fw{ fs, {} };
+                f->memoryUsage(fw);
+                heap.push_back({ tileDistance(tileOf(f->getPos())), fs.total(), f->getUID() });
+                std::push_heap(heap.begin(), heap.end(), nearer);
+            }
+        }
+        std::fflush(m_file);
+    }
+
+    bool PagedGraph::pageOut(BaseNode& node)
+    {
+        // Page: the links feeding the node, then its snapshot. Links leaving it are in the pages of the nodes it feeds
+        m_buffer.clear();
+        record_put(m_buffer, uint32_t(0));
+        uint32_t count = 0;
+        for (auto &p: node.getIns()) {
+            std::shared_ptr<Link> l = p->getLink().lock();
+            if (!l)
+                continue;
+            record_put(m_buffer, static_cast<uint64_t>(l->left()->getParent()->getUID()));
+            record_put(m_buffer, static_cast<uint64_t>(l->left()->getUid()));
+            record_put(m_buffer, static_cast<uint64_t>(p->getUid()));
+            count++;
+        }
+        std::memcpy(m_buffer.data(), &count, sizeof(count));
+        write_node_record(m_registry, node, m_buffer);
+
+        if (!seek_file(m_file, m_fileSize) || std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size())
+            return false;
+
+        NodeUID uid = node.getUID();
+        uint64_t tile = tileOf(node.getPos());
+        m_pages[uid] = Page{ m_fileSize, static_cast<uint32_t>(m_buffer.size()), tile };
+        m_tiles[tile].push_back(uid);
+        m_fileSize += m_buffer.size();
+        m_inf.removeNode(uid);
+        return true;
+    }
+
+    bool PagedGraph::readPage(const Page& page, std::vector<std::byte>& out)
+    {
+        out.resize(page.size);
+        return seek_file(m_file, page.offset) && std::fread(out.data(), 1, page.size, m_file) == page.size;
+    }
+
+    bool PagedGraph::materialize(NodeUID uid)
+    {
+        if (!m_pages.count(uid))
+            return m_inf.getNodes().count(uid) != 0;
+
+        // Feeders first: paged-out nodes never feed each other in a cycle
+        PagingMute mute(m_inf);
+        std::vector<NodeUID> stack{ uid };
+        while (!stack.empty()) {
+            auto it = m_pages.find(stack.back());
+            if (it == m_pages.end()) {
+                stack.pop_back();
+                continue;
+            }
+            if (!readPage(it->second, m_buffer))
+                return false;
+
+            RecordReader r{ m_buffer };
+            auto count = r.get<uint32_t>();
+            bool ready = true;
+            for (uint32_t i = 0; i < count && r.ok; i++) {
+                auto from = static_cast<NodeUID>(r.get<uint64_t>());
+                (void)r.get<uint64_t>();
+                (void)r.get<uint64_t>();
+                if (m_pages.count(from)) {
+                    stack.push_back(from);
+                    ready = false;
+                }
+            }
+            if (!ready)
+                continue;
+            stack.pop_back();
+            pageIn(it->first, m_buffer);
+        }
+        return true;
+    }
+
+    void PagedGraph::pageIn(NodeUID uid, std::span<const std::byte> bytes)
+    {
+        struct Feed
+        {
+            NodeUID node;
+            PinUID  out;
+            PinUID  in;
+        };
+        RecordReader r{ bytes };
+        std::vector<Feed> feeds(r.get<uint32_t>());
+        for (auto &f: feeds) {
+            f.node = static_cast<NodeUID>(r.get<uint64_t>());
+            f.out = static_cast<PinUID>(r.get<uint64_t>());
+            f.in = static_cast<PinUID>(r.get<uint64_t>());
+        }
+        // Recreated while its UID is still reserved, so that no new node takes it
+        std::shared_ptr<BaseNode> n = r.ok ? read_node_record(m_registry, m_inf, r) : nullptr;
+        m_garbage += bytes.size();
+        m_pages.erase(uid);
+        if (!n)
+            return;
+
+        auto& nodes = m_inf.getNodes();
+        for (auto &f: feeds) {
+            auto it = nodes.find(f.node);
+            if (it == nodes.end())
+                continue;
+            Pin* out = record_pin(*it->second, f.out, true);
+            Pin* in = record_pin(*n, f.in, false);
+            if (out && in)
+                in->createLink(out);
+        }
+    }
+
+    bool PagedGraph::readPages(const std::function<void(std::span<const std::byte> record)>& node,
+                               const std::function<void(uint64_t outNode, uint64_t outPin, uint64_t inNode, uint64_t inPin)>& link)
+    {
+        // Links once all the nodes are out, so that both ends exist when they are read back
+        std::vector<uint64_t> links;
+        std::vector<std::byte> page;
+        for (auto &p: m_pages) {
+            if (!readPage(p.second, page))
+                return false;
+            RecordReader r{ page };
+            auto count = r.get<uint32_t>();
+            for (uint32_t i = 0; i < count && r.ok; i++) {
+                links.push_back(r.get<uint64_t>());
+                links.push_back(r.get<uint64_t>());
+                links.push_back(static_cast<uint64_t>(p.first));
+                links.push_back(r.get<uint64_t>());
+            }
+            if (!r.ok)
+                return false;
+            node(std::span(page).subspan(r.pos));
+        }
+        for (std::size_t i = 0; i < links.size(); i += 4) { link(links[i], links[i + 1], links[i + 2], links[i + 3]); }
+        return true;
+    }
+
+    bool PagedGraph::materializeAll()
+    {
+        std::vector<std::pair<uint64_t, NodeUID>> order;
+        order.reserve(m_pages.size());
+        for (auto &p: m_pages) { order.emplace_back(p.second.offset, p.first); }
+        std::sort(order.begin(), order.end());
+        bool ok = true;
+        for (auto &o: order) { ok = materialize(o.second) && ok; }
+        m_tiles.clear();
+        m_lastCount = SIZE_MAX;
+        return ok;
+    }
+
+    void PagedGraph::compact()
+    {
+        m_tiles.clear();
+        if (m_pages.empty()) {
+            std::fclose(m_file);
+            m_file = std::fopen(m_path.c_str(), "w+b");
+            m_fileSize = 0;
+            m_garbage = 0;
+            return;
+        }
+
+        // Copy the live pages, in file order, to a new file
+        std::string tmp = m_path + ".tmp";
+        std::FILE* f = std::fopen(tmp.c_str(), "w+b");
+        std::vector<std::pair<uint64_t, NodeUID>> order;
+        order.reserve(m_pages.size());
+        for (auto &p: m_pages) { order.emplace_back(p.second.offset, p.first); }
+        std::sort(order.begin(), order.end());
+
+        std::vector<uint64_t> offsets;
+        offsets.reserve(order.size());
+        uint64_t at = 0;
+        bool ok = f != nullptr;
+        for (std::size_t i = 0; ok && i < order.size(); i++) {
+            const Page& page = m_pages[order[i].second];
+            ok = readPage(page, m_buffer) && std::fwrite(m_buffer.data(), 1, m_buffer.size(), f) == m_buffer.size();
+            offsets.push_back(at);
+            at += page.size;
+        }
+        ok = f && std::fflush(f) == 0 && ok;
+        if (f)
+            std::fclose(f);
+
+        std::error_code ec;
+        if (ok) {
+            std::fclose(m_file);
+            std::filesystem::rename(tmp, m_path, ec);
+            m_file = std::fopen(m_path.c_str(), "r+b");
+        }
+        if (!ok || ec) {
+            std::filesystem::remove(tmp, ec);
+        } else {
+            for (std::size_t i = 0; i < order.size(); i++) { m_pages[order[i].second].offset = offsets[i]; }
+            m_fileSize = at;
+            m_garbage = 0;
+        }
+        for (auto &p: m_pages) { m_tiles[p.second.tile].push_back(p.first); }
+    }
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <span>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <imgui.h>
+#include "node_registry.h"
+
+namespace ImFlow
+{
+    class BaseNode;
+    class ImNodeFlow;
+    typedef uintptr_t NodeUID;
+
+    /**
+     * @brief Keeps only part of a large graph in memory, paging the rest out to a backing file
+     * @details The grid is divided into square tiles. When the measured memory of the nodes exceeds the budget, nodes in
+     *          the tiles farthest from the viewport are written to the backing file and removed from the handler. They
+     *          come back, with their links, when the viewport approaches their tile or when materialize() asks for them.
+     *          <BR> The nodes in memory always include everything upstream of them, so they evaluate as in the full graph:
+     *          a node is paged out only once all the nodes it feeds are. Sinks, nodes in cycles, nodes with dynamic pins
+     *          and nodes of unregistered types are never paged out. The budget is exceeded when they don't fit.
+     *          <BR> Paging isn't reported to the observers, and paged-out nodes aren't in ImNodeFlow::getNodes(): call
+     *          materializeAll() before saving the graph. Journal checkpoints read the pages themselves (see readPages()).
+     *          Must be destroyed before its handler, and paged-out nodes are lost with it.
+     */
+    class PagedGraph
+    {
+    public:
+        /**
+         * @brief <BR>Open the backing file and start paging
+         * @param inf Handler to page
+         * @param path Path of the backing file, truncated. Check isOpen() for failures
+         * @param registry Registry recreating the nodes paged in
+         */
+        PagedGraph(ImNodeFlow& inf, std::string path, const NodeRegistry& registry = node_registry());
+
+        /**
+         * @brief <BR>Stop paging and delete the backing file
+         */
+        ~PagedGraph();
+
+        PagedGraph(const PagedGraph&) = delete;
+        PagedGraph& operator=(const PagedGraph&) = delete;
+
+        /**
+         * @brief <BR>Get file status
+         * @return [TRUE] if the backing file is open
+         */
+        [[nodiscard]] bool isOpen() const noexcept(true) { return m_file != nullptr; }
+
+        /**
+         * @brief <BR>Set the side of the tiles
+         * @details Only while no node is paged out.
+         * @param size Side in grid units
+         */
+        void setTileSize(float size) noexcept(true);
+
+        /**
+         * @brief <BR>Set the number of tiles around the viewport kept in memory
+         * @param tiles Number of tiles on each side
+         */
+        void setMargin(int tiles) noexcept(true)
+        { m_margin = tiles; m_window = {}; }
+
+        /**
+         * @brief <BR>Set the memory budget of the nodes
+         * @details Measured as in ImNodeFlow::memoryStats(): nodes, pins, styles, strings and adjacency lists.
+         * @param bytes Number of bytes
+         */
+        void setBudget(std::size_t bytes) noexcept(true)
+        { m_budget = bytes; m_lastCount = SIZE_MAX; }
+
+        /**
+         * @brief <BR>Page nodes in and out around the viewport of the handler
+         * @details Call once per frame, after ImNodeFlow::update(). Nodes are measured again only when the window of tiles
+         *          or the number of nodes changes.
+         */
+        void update();
+
+        /**
+         * @brief <BR>Page nodes in and out around a viewport
+         * @param min Top-left corner of the viewport, in grid coordinates
+         * @param max Bottom-right corner of the viewport, in grid coordinates
+         */
+        void update(const ImVec2& min, const ImVec2& max);
+
+        /**
+         * @brief <BR>Page in a node and everything upstream of it
+         * @details Call before evaluating a node that may be paged out.
+         * @param uid UID of the node
+         * @return [FALSE] if there's no such node, or reading it failed
+         */
+        bool materialize(NodeUID uid);
+
+        /**
+         * @brief <BR>Page in every node
+         * @return [FALSE] if reading a node failed
+         */
+        bool materializeAll();
+
+        /**
+         * @brief <BR>Read the paged-out nodes without paging them in
+         * @details For writers of the whole graph, e.g. Journal::checkpoint(). All the nodes are visited before the links.
+         * @param node Called with the snapshot of each node (see write_node_record())
+         * @param link Called with the node and pin UIDs of both ends of each link feeding a paged-out node
+         * @return [FALSE] if reading failed
+         */
+        bool readPages(const std::function<void(std::span<const std::byte> record)>& node,
+                       const std::function<void(uint64_t outNode, uint64_t outPin, uint64_t inNode, uint64_t inPin)>& link);
+
+        /**
+         * @brief <BR>Get paging status of a node
+         * @param uid UID of the node
+         * @return [TRUE] if the node is paged out
+         */
+        [[nodiscard]] bool isPaged(NodeUID uid) const noexcept(true)
+        { return m_pages.count(uid) != 0; }
+
+        /**
+         * @brief <BR>Get number of nodes paged out
+         * @return Number of nodes
+         */
+        [[nodiscard]] std::size_t pagedCount() const noexcept(true)
+        { return m_pages.size(); }
+
+        /**
+         * @brief <BR>Get the memory of the nodes in memory, as last measured
+         * @return Number of bytes
+         */
+        [[nodiscard]] std::size_t residentBytes() const noexcept(true)
+        { return m_residentBytes; }
+
+        /**
+         * @brief <BR>Get the size of the backing file
+         * @details Paged-in nodes leave holes, reclaimed once they are half of the file.
+         * @return Number of bytes
+         */
+        [[nodiscard]] std::size_t fileBytes() const noexcept(true)
+        { return m_fileSize; }
+
+    private:
+        struct TileRect
+        {
+            int32_t x0 = 1, y0 = 1, x1 = 0, y1 = 0; // Empty by default
+            bool operator==(const TileRect&) const = default;
+        };
+
+        struct Page
+        {
+            uint64_t offset;
+            uint32_t size;
+            uint64_t tile;
+        };
+
+        [[nodiscard]] uint64_t tileOf(const ImVec2& pos) const noexcept(true);
+        [[nodiscard]] int tileDistance(uint64_t tile) const noexcept(true);
+        [[nodiscard]] bool evictable(BaseNode& node) const noexcept(true);
+        void enforceBudget();
+        bool pageOut(BaseNode& node);
+        bool readPage(const Page& page, std::vector<std::byte>& out);
+        void pageIn(NodeUID uid, std::span<const std::byte> bytes);
+        void compact();
+
+        ImNodeFlow&         m_inf;
+        const NodeRegistry& m_registry;
+        std::string         m_path;
+        std::FILE*          m_file = nullptr;
+        std::size_t         m_fileSize = 0;
+        std::size_t         m_garbage = 0;
+        std::vector<std::byte> m_buffer;
+
+        float       m_tileSize = 2048.f;
+        int         m_margin = 1;
+        std::size_t m_budget = std::size_t(256) << 20;
+        std::size_t m_residentBytes = 0;
+        std::size_t m_lastCount = SIZE_MAX;
+        TileRect    m_window;
+
+        std::unordered_map<NodeUID, Page>                  m_pages;
+        // Nodes paged out per tile. May still list nodes paged in one by one, until the next compaction
+        std::unordered_map<uint64_t, std::vector<NodeUID>> m_tiles;
+    };
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <cassert>
+#include <functional>
+#include "graph_instances.h"
+#include "thread_pool.h"
+
+namespace ImFlow
+{
+    class ImNodeFlow;
+
+    /**
+     * @brief How the values of the swept parameters are combined into points
+     */
+    enum SweepMode
+    {
+        SweepMode_Grid, // Every combination of the values. The first parameter varies fastest
+        SweepMode_List  // The i-th point takes the i-th value of every parameter
+    };
+
+    /**
+     * @brief Evaluates a graph over many sets of input values in parallel
+     * @details Each point is an instance of the graph (see GraphInstances): evaluation state is a few columns of values,
+     *          the nodes and the UI are never copied. Only batch processors are evaluated.
+     */
+    class ParameterSweep
+    {
+    public:
+        /**
+         * @brief <BR>Create an empty sweep
+         * @param mode How the parameter values are combined
+         */
+        explicit ParameterSweep(SweepMode mode = SweepMode_Grid) : m_mode(mode) {}
+
+        /**
+         * @brief <BR>Add a swept parameter
+         * @tparam T Data type of the input
+         * @param input Input pin of a batch processor, usually unconnected
+         * @param values Values taken by the input
+         * @return Reference to this sweep
+         */
+        template<class T> ParameterSweep& vary(Pin* input, std::vector<T> values)
+        {
+            assert(!values.empty() && "Empty parameter!");
+            assert((m_mode == SweepMode_Grid || m_axes.empty() || values.size() == m_axes.front().size) && "List parameters must have the same size!");
+            std::size_t size = values.size();
+            m_axes.push_back({size, [input, values = std::move(values)](GraphInstances& g, std::size_t first, std::size_t count, std::size_t stride)
+            {
+                std::span<T> col = g.column<T>(input);
+                if (col.empty())
+                    return;
+                for (std::size_t r = first; r < first + count; r++)
+                    col[r] = values[(r / stride) % values.size()];
+            }});
+            return *this;
+        }
+
+        /**
+         * @brief <BR>Get number of points
+         * @return Number of evaluations the sweep runs
+         */
+        [[nodiscard]] std::size_t size() const noexcept(true)
+        {
+            if (m_axes.empty())
+                return 0;
+            if (m_mode == SweepMode_List)
+                return m_axes.front().size;
+            std::size_t n = 1;
+            for (auto &a: m_axes) { n *= a.size; }
+            return n;
+        }
+
+        /**
+         * @brief <BR>Run the sweep
+         * @details The points are split in chunks, each chunk filled and evaluated by a worker of the pool. Blocks until every chunk is done.
+         * @param inf Handler of the graph
+         * @param pool Pool running the chunks (see ImNodeFlow::getExecutor())
+         * @param chunk Number of points per chunk
+         * @return Table of results: one row per point, a column for each pin of the batch processors (see GraphInstances::column())
+         */
+        GraphInstances run(ImNodeFlow& inf, ThreadPool& pool, std::size_t chunk = 4096) const;
+
+    private:
+        struct Axis
+        {
+            std::size_t size;
+            std::function<void(GraphInstances&, std::size_t, std::size_t, std::size_t)> fill;
+        };
+
+        SweepMode         m_mode;
+        std::vector<Axis> m_axes;
+    };
+}
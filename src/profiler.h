@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+namespace ImFlow
+{
+    class BaseNode;
+
+    /**
+     * @brief <BR>Read the profiler clock
+     * @return Nanoseconds of the monotonic clock
+     */
+    inline uint64_t profile_clock() noexcept(true)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /**
+     * @brief Accumulated cost of a profiled call site
+     */
+    struct ProfileStats
+    {
+        uint64_t ns = 0;
+        uint64_t calls = 0;
+
+        constexpr void add(uint64_t t) noexcept(true) { ns += t; calls++; }
+        constexpr void reset() noexcept(true) { ns = 0; calls = 0; }
+    };
+
+    /**
+     * @brief Profile of a node, as returned by ImNodeFlow::topNodes()
+     */
+    struct NodeProfile
+    {
+        BaseNode*    node;
+        ProfileStats eval;
+        ProfileStats draw;
+
+        [[nodiscard]] constexpr uint64_t total() const noexcept(true) { return eval.ns + draw.ns; }
+    };
+
+    /**
+     * @brief Times a call, excluding the profiled calls nested in it
+     * @details Nested scopes report their elapsed time into the counter of their thread (see ImNodeFlow::profileChildren()),
+     *          so each call only accounts for its own work. Nothing is allocated.
+     */
+    class ProfileScope
+    {
+    public:
+        /**
+         * @brief <BR>Start timing
+         * @param children Counter of the nested time, owned by the thread
+         */
+        explicit ProfileScope(uint64_t& children) noexcept(true)
+          : m_children(children), m_saved(children), m_start(profile_clock())
+        { children = 0; }
+
+        /**
+         * @brief <BR>Stop timing
+         * @return Self time of the call, in nanoseconds
+         */
+        uint64_t stop() noexcept(true)
+        {
+            uint64_t elapsed = profile_clock() - m_start;
+            uint64_t self = elapsed - std::min(m_children, elapsed);
+            m_children = m_saved + elapsed;
+            return self;
+        }
+
+    private:
+        uint64_t& m_children;
+        uint64_t  m_saved;
+        uint64_t  m_start;
+    };
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <deque>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+#include "allocator.h"
+
+namespace ImFlow
+{
+    /**
+     * @brief Minimal pool of worker threads
+     * @details Tasks are run in submission order by the first free worker.
+     *          Tasks still queued when the pool is destroyed are dropped, running ones are waited for.
+     */
+    class ThreadPool
+    {
+    public:
+        /**
+         * @brief <BR>Start the workers
+         * @param threads Number of workers. Set to 0 to use one less than the available hardware threads (at least one)
+         */
+        explicit ThreadPool(unsigned int threads = 0)
+        {
+            // hardware_concurrency() may return 0 when unknown
+            if (threads == 0)
+                threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+            m_workers.reserve(threads);
+            for (unsigned int i = 0; i < threads; i++)
+                m_workers.emplace_back([this](std::stop_token stop) { work(stop); });
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /***/
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard lock(m_mutex);
+                m_tasks.clear();
+                for (auto& w : m_workers)
+                    w.request_stop();
+            }
+            m_cv.notify_all();
+        }
+
+        /**
+         * @brief <BR>Queue a task
+         * @param task Function or lambda expression to be run on a worker
+         */
+        void submit(std::function<void()> task)
+        {
+            {
+                std::lock_guard lock(m_mutex);
+                m_tasks.emplace_back(std::move(task));
+            }
+            m_cv.notify_one();
+        }
+
+        /**
+         * @brief <BR>Get number of workers
+         * @return Number of worker threads
+         */
+        [[nodiscard]] size_t size() const noexcept(true)
+        { return m_workers.size(); }
+
+    private:
+        void work(const std::stop_token& stop)
+        {
+            while (true)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock lock(m_mutex);
+                    m_cv.wait(lock, [&] { return stop.stop_requested() || !m_tasks.empty(); });
+                    if (stop.stop_requested())
+                        return;
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                }
+                task();
+            }
+        }
+
+        std::mutex              m_mutex;
+        std::condition_variable m_cv;
+        std::deque<std::function<void()>, TaggedAllocator<std::function<void()>, AllocTag_Evaluation>> m_tasks;
+        // Last member: workers are joined before the queue they read from is destroyed
+        std::vector<std::jthread, TaggedAllocator<std::jthread, AllocTag_Evaluation>> m_workers;
+    };
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+/**
+ * Scoped trace markers, exported as Chrome trace JSON (chrome://tracing, Perfetto).
+ * Compiled in only when IMNODEFLOW_TRACE is defined: otherwise the macros expand to nothing.
+ *
+ * IMFLOW_TRACE_SCOPE(name)        Marks the rest of the scope. The name must outlive the scope, it is copied (truncated) at its end
+ * IMFLOW_TRACE_PHASES(var, name)  Starts a sequence of phases, the last one ends with the scope
+ * IMFLOW_TRACE_NEXT(var, name)    Ends the current phase of the sequence and starts the next one
+ */
+
+#ifdef IMNODEFLOW_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <ostream>
+#include <string_view>
+#include <functional>
+
+namespace ImFlow
+{
+    /**
+     * @brief Complete event ("ph":"X") of a trace
+     */
+    struct TraceEvent
+    {
+        char     name[48];
+        uint64_t begin;
+        uint64_t duration;
+        uint32_t thread;
+    };
+
+    /**
+     * @brief Lock-free ring buffer of trace events
+     * @details Writers claim a slot with one atomic increment, the oldest events are overwritten.
+     *          Each slot carries a sequence number so that the exporter skips the slots being rewritten.
+     */
+    class TraceBuffer
+    {
+    public:
+        /**
+         * @brief <BR>Allocate the ring
+         * @param capacity Number of events kept. Must be a power of two
+         */
+        explicit TraceBuffer(std::size_t capacity = 1 << 16)
+          : m_mask(capacity - 1), m_slots(std::make_unique<Slot[]>(capacity))
+        {}
+
+        /**
+         * @brief <BR>Record an event. Thread-safe
+         * @param name Name of the event, truncated to 47 characters
+         * @param begin Start in nanoseconds
+         * @param end End in nanoseconds
+         */
+        void record(std::string_view name, uint64_t begin, uint64_t end) noexcept(true)
+        {
+            uint64_t i = m_next.fetch_add(1, std::memory_order_relaxed);
+            Slot& s = m_slots[i & m_mask];
+            s.seq.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::size_t n = std::min(name.size(), sizeof(s.event.name) - 1);
+            std::memcpy(s.event.name, name.data(), n);
+            s.event.name[n] = '\0';
+            s.event.begin = begin;
+            s.event.duration = end - begin;
+            s.event.thread = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+            s.seq.store(i + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief <BR>Write the recorded events as Chrome trace JSON
+         * @param out Stream to write to
+         */
+        void exportChrome(std::ostream& out) const
+        {
+            out << "{\"traceEvents\":[";
+            bool first = true;
+            uint64_t end = m_next.load(std::memory_order_acquire);
+            uint64_t begin = end > m_mask + 1 ? end - m_mask - 1 : 0;
+            for (uint64_t i = begin; i < end; i++)
+            {
+                const Slot& s = m_slots[i & m_mask];
+                if (s.seq.load(std::memory_order_acquire) != i + 1)
+                    continue;
+                TraceEvent e = s.event;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (s.seq.load(std::memory_order_relaxed) != i + 1)
+                    continue;
+
+                out << (first ? "" : ",") << "{\"name\":\"";
+                for (const char* c = e.name; *c; c++)
+                {
+                    if (*c == '"' || *c == '\\')
+                        out << '\\';
+                    out << (static_cast<unsigned char>(*c) < 0x20 ? ' ' : *c);
+                }
+                out << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.thread << ",\"ts\":";
+                writeMicroseconds(out, e.begin);
+                out << ",\"dur\":";
+                writeMicroseconds(out, e.duration);
+                out << "}";
+                first = false;
+            }
+            out << "]}";
+        }
+
+        /**
+         * @brief <BR>Drop every recorded event
+         * @details Not thread-safe: call while nothing records.
+         */
+        void clear() noexcept(true)
+        {
+            for (std::size_t i = 0; i <= m_mask; i++)
+                m_slots[i].seq.store(0, std::memory_order_relaxed);
+            m_next.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        // Chrome expects microseconds: keep the nanoseconds as exact decimals
+        static void writeMicroseconds(std::ostream& out, uint64_t ns)
+        {
+            char frac[4] = { char('0' + ns / 100 % 10), char('0' + ns / 10 % 10), char('0' + ns % 10), '\0' };
+            out << ns / 1000 << '.' << frac;
+        }
+
+        struct Slot
+        {
+            std::atomic<uint64_t> seq = 0;
+            TraceEvent            event{};
+        };
+
+        const std::size_t        m_mask;
+        std::unique_ptr<Slot[]>  m_slots;
+        std::atomic<uint64_t>    m_next = 0;
+    };
+
+    /**
+     * @brief <BR>Get the process-wide trace buffer
+     * @return Reference to the buffer
+     */
+    inline TraceBuffer& trace_buffer()
+    {
+        static TraceBuffer buffer;
+        return buffer;
+    }
+
+    /**
+     * @brief Records the lifetime of a scope in the trace buffer
+     */
+    class TraceScope
+    {
+    public:
+        explicit TraceScope(std::string_view name) noexcept(true)
+          : m_name(name), m_begin(now())
+        {}
+        ~TraceScope() { trace_buffer().record(m_name, m_begin, now()); }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        static uint64_t now() noexcept(true)
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        std::string_view m_name;
+        uint64_t         m_begin;
+    };
+
+    /**
+     * @brief Records consecutive phases of a scope without nesting them
+     */
+    class TracePhases
+    {
+    public:
+        explicit TracePhases(std::string_view name) noexcept(true)
+          : m_name(name), m_begin(now())
+        {}
+        ~TracePhases() { trace_buffer().record(m_name, m_begin, now()); }
+
+        TracePhases(const TracePhases&) = delete;
+        TracePhases& operator=(const TracePhases&) = delete;
+
+        /**
+         * @brief <BR>End the current phase and start the next one
+         * @param name Name of the next phase
+         */
+        void next(std::string_view name) noexcept(true)
+        {
+            TraceBuffer& buffer = trace_buffer();
+            uint64_t t = now();
+            buffer.record(m_name, m_begin, t);
+            m_name = name;
+            m_begin = t;
+        }
+
+    private:
+        static uint64_t now() noexcept(true)
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        std::string_view m_name;
+        uint64_t         m_begin;
+    };
+}
+
+#define IMFLOW_TRACE_CONCAT_(a, b) a##b
+#define IMFLOW_TRACE_CONCAT(a, b) IMFLOW_TRACE_CONCAT_(a, b)
+#define IMFLOW_TRACE_SCOPE(name) ::ImFlow::TraceScope IMFLOW_TRACE_CONCAT(imflow_trace_, __LINE__)(name)
+#define IMFLOW_TRACE_PHASES(var, name) ::ImFlow::TracePhases var(name)
+#define IMFLOW_TRACE_NEXT(var, name) var.next(name)
+
+#else
+
+#define IMFLOW_TRACE_SCOPE(name)
+#define IMFLOW_TRACE_PHASES(var, name)
+#define IMFLOW_TRACE_NEXT(var, name)
+
+#endif
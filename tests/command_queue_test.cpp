@@ -0,0 +1,171 @@
+/**
+ * Posted graph mutations, run by CTest.
+ *
+ * Usage: ImNodeFlowCommandQueueTest
+ *
+ * Commands pushed by several threads while the consumer drains must all run once, each producer's in posting order.
+ * post() futures must carry the returned value, or the exception thrown by the command, and report a broken promise
+ * for the commands dropped with the handler.
+ */
+
+#include <cstdio>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ImNodeFlow.h>
+#include "headless_imgui.h"
+
+using namespace ImFlowBench;
+
+namespace
+{
+    constexpr int Producers = 4;
+    constexpr int PerProducer = 20000;
+
+    // Filled by the consumer only
+    struct Received
+    {
+        std::vector<int> last = std::vector<int>(Producers, -1);
+        int count = 0;
+        int outOfOrder = 0;
+    };
+
+    struct SeqCommand : ImFlow::Command
+    {
+        SeqCommand(Received& r, int producer, int seq) : received(r), producer(producer), seq(seq) {}
+
+        void run(ImFlow::ImNodeFlow&) noexcept(true) override
+        {
+            if (seq != received.last[producer] + 1)
+                received.outOfOrder++;
+            received.last[producer] = seq;
+            received.count++;
+        }
+
+        Received& received;
+        int producer;
+        int seq;
+    };
+
+    class EmptyNode : public ImFlow::BaseNode
+    {
+    public:
+        EmptyNode() { setTitle("empty"); }
+        void draw() noexcept override {}
+    };
+
+    void frame(HeadlessImGui& gui, ImFlow::ImNodeFlow& inf)
+    {
+        gui.beginFrame();
+        inf.update();
+        (void)gui.endFrame();
+    }
+}
+
+#define EXPECT(cond) do { if (!(cond)) { std::fprintf(stderr, "command_queue: %s failed (line %d)\n", #cond, __LINE__); return 1; } } while (0)
+
+int main()
+{
+    HeadlessImGui gui;
+
+    // Several producers, drained while they push
+    {
+        ImFlow::ImNodeFlow inf("queue");
+        ImFlow::CommandQueue queue;
+        Received received;
+        std::vector<std::jthread> producers;
+        for (int p = 0; p < Producers; p++) {
+            producers.emplace_back([&queue, &received, p]()
+            {
+                for (int i = 0; i < PerProducer; i++) { queue.push(new SeqCommand(received, p, i)); }
+            });
+        }
+        for (int spins = 0; received.count < Producers * PerProducer && spins < 100000000; spins++)
+            queue.drain(inf);
+        producers.clear();
+        queue.drain(inf);
+        EXPECT(received.count == Producers * PerProducer);
+        EXPECT(received.outOfOrder == 0);
+        for (int last : received.last) { EXPECT(last == PerProducer - 1); }
+        EXPECT(queue.pop() == nullptr);
+    }
+
+    // Futures of post(), applied in posting order by update()
+    {
+        ImFlow::ImNodeFlow inf("post");
+        std::vector<int> order;
+        std::vector<std::future<int>> values;
+        for (int i = 0; i < 8; i++) {
+            values.push_back(inf.post([&order, i](ImFlow::ImNodeFlow&) { order.push_back(i); return i * i; }));
+        }
+        std::future<void> done = inf.post([](ImFlow::ImNodeFlow&) {});
+        EXPECT(done.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+        frame(gui, inf);
+        EXPECT(done.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        for (int i = 0; i < 8; i++) {
+            EXPECT(values[i].get() == i * i);
+            EXPECT(order[i] == i);
+        }
+
+        // From other threads, waiting on their futures
+        std::vector<std::jthread> posters;
+        std::atomic<int> posted = 0;
+        for (int p = 0; p < Producers; p++) {
+            posters.emplace_back([&inf, &posted]()
+            {
+                auto n = inf.postNode<EmptyNode>(ImVec2(0, 0)).get();
+                if (n)
+                    posted++;
+            });
+        }
+        for (int i = 0; i < 10000 && posted < Producers; i++) {
+            frame(gui, inf);
+            std::this_thread::yield();
+        }
+        posters.clear();
+        EXPECT(posted == Producers);
+        EXPECT(inf.getNodesCount() == Producers);
+
+        // Destruction and links through nodes that are gone
+        auto a = inf.addNode<EmptyNode>(ImVec2(0, 0));
+        std::future<void> destroyed = inf.postDestroy(a);
+        frame(gui, inf);
+        destroyed.get();
+        EXPECT(inf.getNodesCount() == Producers);
+        std::future<std::weak_ptr<ImFlow::Link>> link = inf.postLink(a, "out", a, "in");
+        a.reset();
+        frame(gui, inf);
+        EXPECT(link.get().expired());
+    }
+
+    // Exceptions reach the future, and the following commands still run
+    {
+        ImFlow::ImNodeFlow inf("throw");
+        std::future<int> thrown = inf.post([](ImFlow::ImNodeFlow&) -> int { throw std::runtime_error("posted"); });
+        std::future<int> after = inf.post([](ImFlow::ImNodeFlow&) { return 7; });
+        frame(gui, inf);
+        bool caught = false;
+        try { (void)thrown.get(); }
+        catch (const std::runtime_error& e) { caught = std::string(e.what()) == "posted"; }
+        EXPECT(caught);
+        EXPECT(after.get() == 7);
+    }
+
+    // Commands dropped with the handler break their promise
+    {
+        std::future<int> dropped;
+        {
+            ImFlow::ImNodeFlow inf("dropped");
+            dropped = inf.post([](ImFlow::ImNodeFlow&) { return 1; });
+        }
+        bool broken = false;
+        try { (void)dropped.get(); }
+        catch (const std::future_error& e) { broken = e.code() == std::future_errc::broken_promise; }
+        EXPECT(broken);
+    }
+
+    std::puts("command_queue: ok");
+    return 0;
+}
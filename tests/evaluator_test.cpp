@@ -0,0 +1,208 @@
+/**
+ * Threaded evaluation, run by CTest.
+ *
+ * Usage: ImNodeFlowEvaluatorTest
+ *
+ * While the evaluator runs, every value drawn in a frame must come from the same published pass, and passes must
+ * never be drawn out of order. Pins shown, links dropped and nodes posted from update() meanwhile must land in the
+ * graph at the end of the frame, and be published by the next passes.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <thread>
+#include <ImNodeFlow.h>
+#include "headless_imgui.h"
+
+using namespace ImFlowBench;
+
+namespace
+{
+    // One new value per pass: each pass stamps its own evaluation frame
+    class CounterNode : public ImFlow::BaseNode
+    {
+    public:
+        CounterNode()
+        {
+            setTitle("counter");
+            (void)addOUT<int>("out")->behaviour([this]() { return ++m_count; });
+        }
+
+        void draw() noexcept override {}
+
+    private:
+        int m_count = 0;
+    };
+
+    // Slow enough for update() to draw in the middle of the passes
+    class ScaleNode : public ImFlow::BaseNode
+    {
+    public:
+        explicit ScaleNode(int factor)
+        {
+            setTitle("scale");
+            (void)addIN<int>("in", 0, ImFlow::ConnectionFilter::None());
+            (void)addOUT<int>("out")->behaviour([this, factor]()
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                return getInVal<int>("in") * factor;
+            });
+        }
+
+        void draw() noexcept override {}
+    };
+
+    // Outputs that can't be copied are evaluated, but never published
+    class OwnerNode : public ImFlow::BaseNode
+    {
+    public:
+        OwnerNode()
+        {
+            setTitle("owner");
+            (void)addOUT<std::unique_ptr<int>>("out")->behaviour([]() { return std::make_unique<int>(1); });
+        }
+
+        void draw() noexcept override {}
+    };
+
+    // Reads a value and its double in draw(), and shows an output once asked to
+    class ProbeNode : public ImFlow::BaseNode
+    {
+    public:
+        ProbeNode()
+        {
+            setTitle("probe");
+            (void)addIN<int>("x", 0, ImFlow::ConnectionFilter::None());
+            (void)addIN<int>("y", 0, ImFlow::ConnectionFilter::None());
+        }
+
+        void draw() noexcept override
+        {
+            int x = getInVal<int>("x");
+            int y = getInVal<int>("y");
+            if (y != 2 * x)
+                torn++;
+            if (x < last)
+                backwards++;
+            last = x;
+            if (showDynamic)
+                showOUT<int>("dyn", []() { return 7; });
+        }
+
+        int last = 0;
+        int torn = 0;
+        int backwards = 0;
+        bool showDynamic = false;
+    };
+
+    class SinkNode : public ImFlow::BaseNode
+    {
+    public:
+        SinkNode()
+        {
+            setTitle("sink");
+            (void)addIN<int>("in", 0, ImFlow::ConnectionFilter::None());
+        }
+
+        void draw() noexcept override
+        { seen = getInVal<int>("in"); }
+
+        int seen = 0;
+    };
+
+    void frame(HeadlessImGui& gui, ImFlow::ImNodeFlow& inf)
+    {
+        gui.beginFrame();
+        inf.update();
+        (void)gui.endFrame();
+    }
+
+    // Draws frames until the input is linked: a frame may leave its edits to the next one if a pass holds the graph too long
+    bool waitLinked(HeadlessImGui& gui, ImFlow::ImNodeFlow& inf, ImFlow::Pin* in)
+    {
+        for (int i = 0; i < 1000 && !in->isConnected(); i++)
+            frame(gui, inf);
+        return in->isConnected();
+    }
+
+    // Draws frames until the probe sees the counter move by "passes", or gives up
+    bool waitPasses(HeadlessImGui& gui, ImFlow::ImNodeFlow& inf, ProbeNode& probe, int passes)
+    {
+        int target = probe.last + passes;
+        for (int i = 0; i < 20000 && probe.last < target; i++) {
+            frame(gui, inf);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return probe.last >= target;
+    }
+}
+
+#define EXPECT(cond) do { if (!(cond)) { std::fprintf(stderr, "evaluator: %s failed (line %d)\n", #cond, __LINE__); return 1; } } while (0)
+
+int main()
+{
+    HeadlessImGui gui;
+
+    ImFlow::ImNodeFlow inf("evaluator");
+    auto counter = inf.addNode<CounterNode>({0, 0});
+    auto twice = inf.addNode<ScaleNode>({0, 0}, 2);
+    auto probe = inf.addNode<ProbeNode>({0, 0});
+    (void)inf.addNode<OwnerNode>({0, 0});
+    twice->inPin("in")->createLink(counter->outPin("out"));
+    probe->inPin("x")->createLink(counter->outPin("out"));
+    probe->inPin("y")->createLink(twice->outPin("out"));
+
+    // Every frame draws a single pass
+    inf.startEvaluator();
+    EXPECT(inf.isEvaluatorRunning());
+    EXPECT(waitPasses(gui, inf, *probe, 50));
+    EXPECT(probe->torn == 0);
+    EXPECT(probe->backwards == 0);
+
+    // A link dropped from update() lands in the structural phase
+    std::shared_ptr<SinkNode> sink;
+    {
+        auto lock = inf.lockGraph();
+        sink = inf.addNode<SinkNode>({0, 0});
+        inf.postLinkEdit(twice->outPin("out"), sink->inPin("in"), true);
+    }
+    EXPECT(!sink->inPin("in")->isConnected());
+    EXPECT(waitLinked(gui, inf, sink->inPin("in")));
+    EXPECT(waitPasses(gui, inf, *probe, 5));
+    EXPECT(sink->seen > 0 && sink->seen % 2 == 0);
+
+    // A pin shown from draw() is staged, then evaluated with the others
+    probe->showDynamic = true;
+    EXPECT(waitPasses(gui, inf, *probe, 5));
+
+    // A node posted from another thread joins the passes
+    auto posted = std::async(std::launch::async, [&inf]() { return inf.postNode<ScaleNode>(ImVec2(0, 0), 3).get(); });
+    std::shared_ptr<ScaleNode> thrice;
+    for (int i = 0; i < 1000 && !thrice; i++) {
+        frame(gui, inf);
+        if (posted.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready)
+            thrice = posted.get();
+    }
+    EXPECT(thrice != nullptr);
+    (void)inf.postLink(counter, "out", thrice, "in");
+    EXPECT(waitLinked(gui, inf, thrice->inPin("in")));
+    EXPECT(waitPasses(gui, inf, *probe, 5));
+    EXPECT(probe->torn == 0);
+    EXPECT(probe->backwards == 0);
+
+    // Back to update(): values are evaluated in the frame again
+    inf.stopEvaluator();
+    EXPECT(!inf.isEvaluatorRunning());
+    int before = probe->last;
+    frame(gui, inf);
+    EXPECT(probe->last > before);
+    before = probe->last;
+    frame(gui, inf);
+    EXPECT(probe->last == before + 1);
+    EXPECT(probe->torn == 0);
+
+    std::puts("evaluator: ok");
+    return 0;
+}
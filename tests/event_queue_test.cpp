@@ -0,0 +1,139 @@
+/**
+ * Event stream queues, run by CTest.
+ *
+ * Usage: ImNodeFlowEventQueueTest
+ *
+ * For each StreamPolicy, several producers push numbered items into a small queue drained by the main thread.
+ * Every item must be either drained or counted as dropped, each producer's items must come out in push order,
+ * and StreamPolicy_Block must drop nothing. A full queue must then apply the policy as documented.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "event_queue.h"
+
+using namespace ImFlow;
+
+namespace
+{
+    constexpr uint32_t Producers = 4;
+    constexpr uint32_t PerProducer = 20000;
+
+    struct Drained
+    {
+        std::vector<int64_t> last = std::vector<int64_t>(Producers, -1);
+        uint64_t count = 0;
+        uint64_t gaps = 0;
+        uint64_t outOfOrder = 0;
+
+        void operator()(uint32_t item)
+        {
+            uint32_t producer = item >> 24, seq = item & 0xFFFFFF;
+            if (seq <= last[producer])
+                outOfOrder++;
+            else if (seq != last[producer] + 1)
+                gaps++;
+            last[producer] = seq;
+            count++;
+        }
+    };
+
+    // Producers push while the calling thread drains
+    Drained run(StreamPolicy policy, uint64_t& drops)
+    {
+        EventQueue<uint32_t> queue(64, policy);
+        Drained drained;
+        std::atomic<uint32_t> finished = 0;
+        std::vector<std::jthread> producers;
+        for (uint32_t p = 0; p < Producers; p++) {
+            producers.emplace_back([&queue, &finished, p]()
+            {
+                for (uint32_t i = 0; i < PerProducer; i++) { queue.push((p << 24) | i); }
+                finished++;
+            });
+        }
+        while (finished < Producers)
+            (void)queue.drain([&drained](uint32_t item) { drained(item); }, 16);
+        producers.clear();
+        while (queue.drain([&drained](uint32_t item) { drained(item); }, 1024) > 0) {}
+        drops = queue.drops();
+        return drained;
+    }
+
+    std::vector<int> drainAll(EventQueue<int>& queue)
+    {
+        std::vector<int> out;
+        (void)queue.drain([&out](int item) { out.push_back(item); }, 1024);
+        return out;
+    }
+}
+
+#define EXPECT(cond) do { if (!(cond)) { std::fprintf(stderr, "event_queue: %s failed (line %d)\n", #cond, __LINE__); return 1; } } while (0)
+
+int main()
+{
+    constexpr uint64_t Total = uint64_t(Producers) * PerProducer;
+
+    // Concurrent producers
+    {
+        uint64_t drops = 0;
+        Drained d = run(StreamPolicy_Block, drops);
+        EXPECT(drops == 0);
+        EXPECT(d.count == Total);
+        EXPECT(d.gaps == 0 && d.outOfOrder == 0);
+        for (int64_t last : d.last) { EXPECT(last == PerProducer - 1); }
+    }
+    {
+        uint64_t drops = 0;
+        Drained d = run(StreamPolicy_DropOldest, drops);
+        EXPECT(d.count + drops == Total);
+        EXPECT(d.outOfOrder == 0);
+    }
+    {
+        uint64_t drops = 0;
+        Drained d = run(StreamPolicy_Coalesce, drops);
+        EXPECT(d.count + drops == Total);
+        EXPECT(d.outOfOrder == 0);
+    }
+
+    // Full queue, single thread
+    {
+        EventQueue<int> queue(4, StreamPolicy_Block);
+        for (int i = 0; i < 4; i++) { queue.push(i); }
+        int item = 4;
+        EXPECT(!queue.tryPush(item));
+        EXPECT(queue.depth() == 4);
+        EXPECT((drainAll(queue) == std::vector<int>{0, 1, 2, 3}));
+    }
+    {
+        EventQueue<int> queue(4, StreamPolicy_DropOldest);
+        for (int i = 0; i < 6; i++) { queue.push(i); }
+        EXPECT(queue.drops() == 2);
+        EXPECT((drainAll(queue) == std::vector<int>{2, 3, 4, 5}));
+    }
+    {
+        // The newest overflowing item replaces the previous one, and comes after the ring
+        EventQueue<int> queue(4, StreamPolicy_Coalesce);
+        for (int i = 0; i < 6; i++) { queue.push(i); }
+        EXPECT(queue.drops() == 1);
+        EXPECT(queue.depth() == 5);
+        EXPECT((drainAll(queue) == std::vector<int>{0, 1, 2, 3, 5}));
+
+        // Room in the ring doesn't let later items overtake the one set aside: they replace it
+        for (int i = 0; i < 5; i++) { queue.push(i); }
+        std::vector<int> first;
+        (void)queue.drain([&first](int item) { first.push_back(item); }, 2);
+        queue.push(5);
+        std::vector<int> rest = drainAll(queue);
+        first.insert(first.end(), rest.begin(), rest.end());
+        EXPECT((first == std::vector<int>{0, 1, 2, 3, 5}));
+        EXPECT(queue.drops() == 2);
+        EXPECT(queue.depth() == 0);
+    }
+
+    std::puts("event_queue: ok");
+    return 0;
+}
@@ -0,0 +1,118 @@
+/**
+ * Memoized outputs, run by CTest.
+ *
+ * Usage: ImNodeFlowMemoTest
+ *
+ * A cached result must only be returned for inputs equal to the ones it was computed from: inputs whose hashes
+ * collide must run the behaviour again, and so must a dynamic input shown, hidden or holding another value.
+ */
+
+#include <cstdio>
+#include <ImNodeFlow.h>
+#include "headless_imgui.h"
+
+using namespace ImFlowBench;
+
+namespace
+{
+    class SourceNode : public ImFlow::BaseNode
+    {
+    public:
+        SourceNode()
+        {
+            setTitle("source");
+            (void)addOUT<int>("out")->behaviour([this]() { return value; });
+        }
+
+        void draw() noexcept override {}
+
+        int value = 0;
+    };
+
+    // Every value of "a" has the same hash, "d" is shown from draw() when asked to
+    class MemoNode : public ImFlow::BaseNode
+    {
+    public:
+        MemoNode()
+        {
+            setTitle("memo");
+            (void)addIN<int>("a", 0, ImFlow::ConnectionFilter::None())->hasher([](const int&) { return std::size_t(1); });
+            (void)addOUT<int>("out")->behaviour([this]() { runs++; return getInVal<int>("a") * 10; })->memoize(8);
+        }
+
+        void draw() noexcept override
+        {
+            if (dynamic)
+                (void)showIN<int>("d", dynamicDefault, ImFlow::ConnectionFilter::None());
+        }
+
+        int out()
+        { return static_cast<ImFlow::OutPin<int>*>(outPin("out"))->val(); }
+
+        int runs = 0;
+        bool dynamic = false;
+        int dynamicDefault = 0;
+    };
+
+    void frame(HeadlessImGui& gui, ImFlow::ImNodeFlow& inf)
+    {
+        gui.beginFrame();
+        inf.update();
+        (void)gui.endFrame();
+    }
+
+    // The output has no consumer: it is only evaluated when the test reads it
+    void frames(HeadlessImGui& gui, ImFlow::ImNodeFlow& inf, int count)
+    {
+        for (int i = 0; i < count; i++)
+            frame(gui, inf);
+    }
+}
+
+#define EXPECT(cond) do { if (!(cond)) { std::fprintf(stderr, "memo: %s failed (line %d)\n", #cond, __LINE__); return 1; } } while (0)
+
+int main()
+{
+    HeadlessImGui gui;
+
+    ImFlow::ImNodeFlow inf("memo");
+    auto source = inf.addNode<SourceNode>({0, 0});
+    auto memo = inf.addNode<MemoNode>({0, 0});
+    memo->inPin("a")->createLink(source->outPin("out"));
+
+    // Colliding hashes are told apart by the values
+    source->value = 1;
+    frame(gui, inf);
+    EXPECT(memo->out() == 10);
+    EXPECT(memo->runs == 1);
+    source->value = 2;
+    frame(gui, inf);
+    EXPECT(memo->out() == 20);
+    EXPECT(memo->runs == 2);
+    source->value = 1;
+    frame(gui, inf);
+    EXPECT(memo->out() == 10);
+    EXPECT(memo->runs == 2);
+
+    // Dynamic inputs are part of the key
+    memo->dynamic = true;
+    memo->dynamicDefault = 5;
+    frames(gui, inf, 3);
+    EXPECT(memo->out() == 10);
+    EXPECT(memo->runs == 3);
+    frame(gui, inf);
+    EXPECT(memo->out() == 10);
+    EXPECT(memo->runs == 3);
+
+    // Shown again holding another value, under the same UID
+    memo->dynamic = false;
+    frames(gui, inf, 2);
+    memo->dynamic = true;
+    memo->dynamicDefault = 7;
+    frames(gui, inf, 3);
+    EXPECT(memo->out() == 10);
+    EXPECT(memo->runs == 4);
+
+    std::puts("memo: ok");
+    return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * Incremental topological order, run by CTest.
+ *
+ * Usage: ImNodeFlowTopologyTest
+ *
+ * Links closing a cycle must be rejected while cycles are not allowed, and flagged as cyclic otherwise.
+ * Links added against the current order must reorder the nodes. Removing the link or the node that closes
+ * a cycle must un-flag the cyclic links that fit in the order again, and only those.
+ */
+
+#include <cstdio>
+#include <ImNodeFlow.h>
+#include "headless_imgui.h"
+
+using namespace ImFlowBench;
+
+namespace
+{
+    class TopoNode : public ImFlow::BaseNode
+    {
+    public:
+        TopoNode()
+        {
+            setTitle("topo");
+            (void)addIN<int>("a", 0, ImFlow::ConnectionFilter::None());
+            (void)addIN<int>("b", 0, ImFlow::ConnectionFilter::None());
+            (void)addOUT<int>("out")->behaviour([this]() { return getInVal<int>("a") + getInVal<int>("b") + 1; });
+        }
+
+        void draw() noexcept override {}
+    };
+
+    bool before(const std::shared_ptr<TopoNode>& a, const std::shared_ptr<TopoNode>& b)
+    { return a->getTopoIndex() < b->getTopoIndex(); }
+
+    bool cyclic(ImFlow::Pin* in)
+    {
+        auto link = in->getLink().lock();
+        return link && link->isCyclic();
+    }
+}
+
+#define EXPECT(cond) do { if (!(cond)) { std::fprintf(stderr, "topology: %s failed (line %d)\n", #cond, __LINE__); return 1; } } while (0)
+
+int main()
+{
+    HeadlessImGui gui;
+
+    // Cycles rejected
+    {
+        ImFlow::ImNodeFlow inf("rejected");
+        auto a = inf.addNode<TopoNode>({0, 0});
+        auto b = inf.addNode<TopoNode>({0, 0});
+        auto c = inf.addNode<TopoNode>({0, 0});
+        b->inPin("a")->createLink(a->outPin("out"));
+        c->inPin("a")->createLink(b->outPin("out"));
+        a->inPin("a")->createLink(c->outPin("out"));
+        EXPECT(!a->inPin("a")->isConnected());
+        EXPECT(inf.getLinks().size() == 2);
+        EXPECT(inf.isAcyclic());
+        EXPECT(before(a, b) && before(b, c));
+    }
+
+    // Links against the insertion order reorder the nodes
+    {
+        ImFlow::ImNodeFlow inf("reorder");
+        auto c = inf.addNode<TopoNode>({0, 0});
+        auto b = inf.addNode<TopoNode>({0, 0});
+        auto a = inf.addNode<TopoNode>({0, 0});
+        auto d = inf.addNode<TopoNode>({0, 0});
+        c->inPin("a")->createLink(b->outPin("out"));
+        b->inPin("a")->createLink(a->outPin("out"));
+        d->inPin("a")->createLink(c->outPin("out"));
+        EXPECT(before(a, b) && before(b, c) && before(c, d));
+
+        // Reversing the chain through a new path is a cycle
+        a->inPin("b")->createLink(d->outPin("out"));
+        EXPECT(!a->inPin("b")->isConnected());
+        EXPECT(inf.isAcyclic());
+    }
+
+    // Cycles allowed: flagged, then un-flagged once broken
+    {
+        ImFlow::ImNodeFlow inf("allowed");
+        inf.allowCycles(true);
+        auto a = inf.addNode<TopoNode>({0, 0});
+        auto b = inf.addNode<TopoNode>({0, 0});
+        auto c = inf.addNode<TopoNode>({0, 0});
+        b->inPin("a")->createLink(a->outPin("out"));
+        c->inPin("a")->createLink(b->outPin("out"));
+        a->inPin("a")->createLink(c->outPin("out"));
+        EXPECT(a->inPin("a")->isConnected() && cyclic(a->inPin("a")));
+        EXPECT(!cyclic(b->inPin("a")) && !cyclic(c->inPin("a")));
+        EXPECT(!inf.isAcyclic());
+
+        // A second cyclic link, closed through the same dependency
+        b->inPin("b")->createLink(c->outPin("out"));
+        EXPECT(cyclic(b->inPin("b")));
+
+        // Breaking b -> c fits c -> a and c -> b in the order
+        c->inPin("a")->deleteLink();
+        EXPECT(!cyclic(a->inPin("a")) && !cyclic(b->inPin("b")));
+        EXPECT(inf.isAcyclic());
+        EXPECT(before(c, a) && before(a, b) && before(c, b));
+
+        // Removing a cyclic link itself doesn't reorder anything
+        c->inPin("a")->createLink(b->outPin("out"));
+        EXPECT(cyclic(c->inPin("a")));
+        c->inPin("a")->deleteLink();
+        EXPECT(inf.isAcyclic());
+    }
+
+    // Removing a node un-flags only the links whose cycle went through it
+    {
+        ImFlow::ImNodeFlow inf("node");
+        inf.allowCycles(true);
+        auto a = inf.addNode<TopoNode>({0, 0});
+        auto b = inf.addNode<TopoNode>({0, 0});
+        auto c = inf.addNode<TopoNode>({0, 0});
+        auto d = inf.addNode<TopoNode>({0, 0});
+        b->inPin("a")->createLink(a->outPin("out"));
+        c->inPin("a")->createLink(b->outPin("out"));
+        a->inPin("a")->createLink(c->outPin("out"));
+        d->inPin("a")->createLink(a->outPin("out"));
+        a->inPin("b")->createLink(d->outPin("out"));
+        EXPECT(cyclic(a->inPin("a")) && cyclic(a->inPin("b")));
+
+        EXPECT(inf.removeNode(b->getUID()));
+        b.reset();
+        EXPECT(!cyclic(a->inPin("a")) && cyclic(a->inPin("b")));
+        EXPECT(!inf.isAcyclic());
+        EXPECT(before(c, a));
+    }
+
+    std::puts("topology: ok");
+    return 0;
+}